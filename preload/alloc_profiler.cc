@@ -0,0 +1,505 @@
+// Library, that gets preloaded (LD_PRELOAD) into executables, that are run
+// with allocation profiling. It interposes malloc() and friends, counts
+// allocations of the whole process exactly and attributes them to call sites
+// by sampling backtraces. Once the process exits, the report gets written to
+// the file, specified by CDT_ALLOC_PROFILE.
+//
+// Code in here can't allocate memory through the heap, so all the tables are
+// static and fixed in size.
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <elf.h>
+#include <execinfo.h>
+#include <link.h>
+#include <malloc.h>
+#include <sys/auxv.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+typedef void* (*MallocFn)(size_t);
+typedef void (*FreeFn)(void*);
+typedef void* (*CallocFn)(size_t, size_t);
+typedef void* (*ReallocFn)(void*, size_t);
+typedef int (*PosixMemalignFn)(void**, size_t, size_t);
+typedef void* (*AlignedAllocFn)(size_t, size_t);
+
+// Frames of allocating functions themselves are not part of call sites.
+constexpr int kSkippedFrames = 2;
+constexpr int kMaxFrames = 32;
+// Both tables are open-addressed, so their sizes are powers of 2.
+constexpr uint32_t kMaxSites = 1 << 14;
+constexpr uint32_t kMaxBlocks = 1 << 18;
+// Backtrace of every N-th allocation is sampled, unless it is configured
+// with CDT_ALLOC_SAMPLE_INTERVAL.
+constexpr uint32_t kDefaultSampleInterval = 16;
+// Allocations, that are at least this large, are always sampled.
+constexpr size_t kLargeAllocation = 64 * 1024;
+
+struct Site {
+  uint64_t hash;
+  int depth;
+  void* frames[kMaxFrames];
+  uint64_t allocations;
+  uint64_t bytes;
+  int64_t live_bytes;
+  int64_t peak_bytes;
+};
+
+// Sampled allocation, that has not been freed yet.
+struct Block {
+  void* ptr;
+  uint32_t site;
+  int64_t bytes;
+};
+
+MallocFn real_malloc;
+FreeFn real_free;
+CallocFn real_calloc;
+ReallocFn real_realloc;
+PosixMemalignFn real_posix_memalign;
+AlignedAllocFn real_aligned_alloc;
+AlignedAllocFn real_memalign;
+
+// dlsym() might allocate memory itself, while the real functions are being
+// resolved.
+alignas(16) char bootstrap_arena[16 * 1024];
+size_t bootstrap_used;
+bool resolving;
+
+bool enabled;
+pid_t profiled_pid;
+char report_path[4096];
+// Module name of the executable itself is either empty or relative to the
+// directory, it has been started in. Its path is resolved in the profiled
+// process, since "/proc/self/exe" would mean addr2line to the app.
+char executable_path[4096];
+void* executable_base;
+uint32_t sample_interval = kDefaultSampleInterval;
+
+std::atomic<uint64_t> total_allocations;
+std::atomic<uint64_t> total_bytes;
+std::atomic<int64_t> heap_size;
+std::atomic<int64_t> peak_heap_size;
+
+std::atomic_flag tables_lock = ATOMIC_FLAG_INIT;
+// Site 0 collects allocations of call sites, that did not fit into the table.
+Site sites[kMaxSites];
+uint32_t site_count = 1;
+Block blocks[kMaxBlocks];
+// Read without the lock, to not take it on each free().
+std::atomic<uint32_t> block_count;
+
+// Allocations, that happen inside of the profiler itself (e.g. the ones of
+// backtrace()), are not profiled.
+__thread bool in_profiler __attribute__((tls_model("initial-exec")));
+__thread uint32_t allocations_until_sample
+    __attribute__((tls_model("initial-exec")));
+
+class ProfilerScope {
+ public:
+  ProfilerScope() { in_profiler = true; }
+  ~ProfilerScope() { in_profiler = false; }
+};
+
+class TablesLock {
+ public:
+  TablesLock() {
+    while (tables_lock.test_and_set(std::memory_order_acquire)) {
+    }
+  }
+  ~TablesLock() { tables_lock.clear(std::memory_order_release); }
+};
+
+void ResolveFunctions() {
+  resolving = true;
+  real_malloc = reinterpret_cast<MallocFn>(dlsym(RTLD_NEXT, "malloc"));
+  real_free = reinterpret_cast<FreeFn>(dlsym(RTLD_NEXT, "free"));
+  real_calloc = reinterpret_cast<CallocFn>(dlsym(RTLD_NEXT, "calloc"));
+  real_realloc = reinterpret_cast<ReallocFn>(dlsym(RTLD_NEXT, "realloc"));
+  real_posix_memalign =
+      reinterpret_cast<PosixMemalignFn>(dlsym(RTLD_NEXT, "posix_memalign"));
+  real_aligned_alloc =
+      reinterpret_cast<AlignedAllocFn>(dlsym(RTLD_NEXT, "aligned_alloc"));
+  real_memalign =
+      reinterpret_cast<AlignedAllocFn>(dlsym(RTLD_NEXT, "memalign"));
+  resolving = false;
+}
+
+void* AllocateFromBootstrapArena(size_t size) {
+  size = (size + 15) & ~static_cast<size_t>(15);
+  if (bootstrap_used + size > sizeof(bootstrap_arena)) {
+    return nullptr;
+  }
+  void* ptr = bootstrap_arena + bootstrap_used;
+  bootstrap_used += size;
+  return ptr;
+}
+
+bool IsFromBootstrapArena(void* ptr) {
+  return ptr >= bootstrap_arena &&
+         ptr < bootstrap_arena + sizeof(bootstrap_arena);
+}
+
+void UpdatePeak(std::atomic<int64_t>& peak, int64_t value) {
+  int64_t current = peak.load(std::memory_order_relaxed);
+  while (value > current &&
+         !peak.compare_exchange_weak(current, value,
+                                     std::memory_order_relaxed)) {
+  }
+}
+
+uint64_t HashFrames(void* const* frames, int depth) {
+  uint64_t hash = 14695981039346656037ull;
+  for (int i = 0; i < depth; i++) {
+    hash ^= reinterpret_cast<uintptr_t>(frames[i]);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+uint64_t HashPointer(void* ptr) {
+  uint64_t hash = reinterpret_cast<uintptr_t>(ptr) >> 4;
+  return hash * 11400714819323198485ull;
+}
+
+// Should be called with the tables locked.
+uint32_t FindOrAddSite(void* const* frames, int depth) {
+  uint64_t hash = HashFrames(frames, depth);
+  // Keep the table at most 3/4 full, so that lookups stay short.
+  bool is_full = site_count >= kMaxSites / 4 * 3;
+  for (uint32_t i = hash & (kMaxSites - 1);; i = (i + 1) & (kMaxSites - 1)) {
+    Site& site = sites[i];
+    if (i == 0) {
+      continue;
+    }
+    if (site.depth == 0) {
+      if (is_full) {
+        return 0;
+      }
+      site.hash = hash;
+      site.depth = depth;
+      memcpy(site.frames, frames, depth * sizeof(void*));
+      site_count++;
+      return i;
+    }
+    if (site.hash == hash && site.depth == depth &&
+        memcmp(site.frames, frames, depth * sizeof(void*)) == 0) {
+      return i;
+    }
+  }
+}
+
+// Should be called with the tables locked.
+void AddBlock(void* ptr, uint32_t site, int64_t bytes) {
+  if (block_count >= kMaxBlocks / 4 * 3) {
+    return;
+  }
+  uint32_t i = HashPointer(ptr) & (kMaxBlocks - 1);
+  while (blocks[i].ptr) {
+    i = (i + 1) & (kMaxBlocks - 1);
+  }
+  blocks[i] = {ptr, site, bytes};
+  block_count++;
+}
+
+// Should be called with the tables locked. Returns false if the block has not
+// been sampled.
+bool RemoveBlock(void* ptr, Block& removed) {
+  uint32_t i = HashPointer(ptr) & (kMaxBlocks - 1);
+  while (blocks[i].ptr != ptr) {
+    if (!blocks[i].ptr) {
+      return false;
+    }
+    i = (i + 1) & (kMaxBlocks - 1);
+  }
+  removed = blocks[i];
+  block_count--;
+  // Shift the following blocks of the cluster back, so that lookups don't
+  // stop at the hole.
+  uint32_t hole = i;
+  for (uint32_t j = (i + 1) & (kMaxBlocks - 1); blocks[j].ptr;
+       j = (j + 1) & (kMaxBlocks - 1)) {
+    uint32_t home = HashPointer(blocks[j].ptr) & (kMaxBlocks - 1);
+    if (((j - home) & (kMaxBlocks - 1)) >= ((j - hole) & (kMaxBlocks - 1))) {
+      blocks[hole] = blocks[j];
+      hole = j;
+    }
+  }
+  blocks[hole] = {};
+  return true;
+}
+
+bool ShouldSample(size_t size) {
+  if (size >= kLargeAllocation) {
+    return true;
+  }
+  if (allocations_until_sample == 0) {
+    allocations_until_sample = sample_interval;
+  }
+  return --allocations_until_sample == 0;
+}
+
+// Should not be inlined, since its frame is one of the skipped ones.
+__attribute__((noinline)) void RecordAllocation(void* ptr, size_t size) {
+  if (!ptr || !enabled || in_profiler) {
+    return;
+  }
+  ProfilerScope scope;
+  int64_t usable_size = malloc_usable_size(ptr);
+  total_allocations.fetch_add(1, std::memory_order_relaxed);
+  total_bytes.fetch_add(size, std::memory_order_relaxed);
+  UpdatePeak(peak_heap_size,
+             heap_size.fetch_add(usable_size, std::memory_order_relaxed) +
+                 usable_size);
+  if (!ShouldSample(size)) {
+    return;
+  }
+  void* frames[kMaxFrames + kSkippedFrames];
+  int depth = backtrace(frames, kMaxFrames + kSkippedFrames) - kSkippedFrames;
+  if (depth <= 0) {
+    return;
+  }
+  // Each sampled allocation stands for all the allocations since the
+  // previous sample.
+  uint64_t weight = size >= kLargeAllocation ? 1 : sample_interval;
+  int64_t live_bytes = usable_size * weight;
+  TablesLock lock;
+  uint32_t i = FindOrAddSite(frames + kSkippedFrames, depth);
+  Site& site = sites[i];
+  site.allocations += weight;
+  site.bytes += size * weight;
+  site.live_bytes += live_bytes;
+  if (site.live_bytes > site.peak_bytes) {
+    site.peak_bytes = site.live_bytes;
+  }
+  AddBlock(ptr, i, live_bytes);
+}
+
+// Usable size is passed separately, since the block might have already been
+// freed by realloc().
+void RecordFree(void* ptr, size_t usable_size) {
+  if (!enabled || in_profiler) {
+    return;
+  }
+  ProfilerScope scope;
+  heap_size.fetch_sub(usable_size, std::memory_order_relaxed);
+  if (block_count.load(std::memory_order_relaxed) == 0) {
+    return;
+  }
+  TablesLock lock;
+  Block block;
+  if (RemoveBlock(ptr, block)) {
+    sites[block.site].live_bytes -= block.bytes;
+  }
+}
+
+// Offset of the address, that addr2line expects: relative to the module,
+// unless it is a non-relocatable executable.
+uintptr_t GetModuleOffset(void* address, const Dl_info& info) {
+  auto header = static_cast<const ElfW(Ehdr)*>(info.dli_fbase);
+  uintptr_t result = reinterpret_cast<uintptr_t>(address);
+  if (header->e_type != ET_EXEC) {
+    result -= reinterpret_cast<uintptr_t>(info.dli_fbase);
+  }
+  return result;
+}
+
+void WriteFrame(FILE* file, void* frame) {
+  // Frames are return addresses, that point to instructions after the calls.
+  void* address = static_cast<char*>(frame) - 1;
+  Dl_info info;
+  if (!dladdr(address, &info) || !info.dli_fname || !info.dli_fbase) {
+    fprintf(file, "frame\t%p\t\t\n", address);
+    return;
+  }
+  const char* module = info.dli_fname;
+  if (info.dli_fbase == executable_base && *executable_path) {
+    module = executable_path;
+  }
+  char* demangled = nullptr;
+  if (info.dli_sname) {
+    int status = 0;
+    demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+  }
+  const char* symbol = "";
+  if (demangled) {
+    symbol = demangled;
+  } else if (info.dli_sname) {
+    symbol = info.dli_sname;
+  }
+  fprintf(file, "frame\t%#lx\t%s\t%s\n",
+          static_cast<unsigned long>(GetModuleOffset(address, info)), module,
+          symbol);
+  free(demangled);
+}
+
+void WriteReport() {
+  FILE* file = fopen(report_path, "w");
+  if (!file) {
+    return;
+  }
+  fprintf(file, "sample_interval\t%u\n", sample_interval);
+  fprintf(file, "total\t%llu\t%llu\t%lld\n",
+          static_cast<unsigned long long>(total_allocations.load()),
+          static_cast<unsigned long long>(total_bytes.load()),
+          static_cast<long long>(peak_heap_size.load()));
+  for (uint32_t i = 0; i < kMaxSites; i++) {
+    const Site& site = sites[i];
+    if (site.allocations == 0) {
+      continue;
+    }
+    fprintf(file, "site\t%llu\t%llu\t%lld\n",
+            static_cast<unsigned long long>(site.allocations),
+            static_cast<unsigned long long>(site.bytes),
+            static_cast<long long>(site.peak_bytes));
+    for (int j = 0; j < site.depth; j++) {
+      WriteFrame(file, site.frames[j]);
+    }
+  }
+  fclose(file);
+}
+
+__attribute__((constructor)) void StartProfiling() {
+  if (!real_malloc) {
+    ResolveFunctions();
+  }
+  const char* path = getenv("CDT_ALLOC_PROFILE");
+  if (!path || strlen(path) >= sizeof(report_path)) {
+    return;
+  }
+  strcpy(report_path, path);
+  if (const char* interval = getenv("CDT_ALLOC_SAMPLE_INTERVAL")) {
+    if (int value = atoi(interval); value > 0) {
+      sample_interval = value;
+    }
+  }
+  // Child processes inherit LD_PRELOAD, but only the profiled process itself
+  // should write the report.
+  unsetenv("CDT_ALLOC_PROFILE");
+  profiled_pid = getpid();
+  ssize_t length =
+      readlink("/proc/self/exe", executable_path, sizeof(executable_path) - 1);
+  executable_path[length > 0 ? length : 0] = '\0';
+  Dl_info executable_info;
+  if (dladdr(reinterpret_cast<void*>(getauxval(AT_ENTRY)), &executable_info)) {
+    executable_base = executable_info.dli_fbase;
+  }
+  {
+    // backtrace() loads the unwinder and allocates memory the first time it
+    // gets called.
+    ProfilerScope scope;
+    void* frames[1];
+    backtrace(frames, 1);
+  }
+  enabled = true;
+}
+
+__attribute__((destructor)) void StopProfiling() {
+  if (!enabled || getpid() != profiled_pid) {
+    return;
+  }
+  in_profiler = true;
+  enabled = false;
+  WriteReport();
+}
+
+}  // namespace
+
+extern "C" {
+
+void* malloc(size_t size) {
+  if (!real_malloc) {
+    if (resolving) {
+      return AllocateFromBootstrapArena(size);
+    }
+    ResolveFunctions();
+  }
+  void* ptr = real_malloc(size);
+  RecordAllocation(ptr, size);
+  return ptr;
+}
+
+void free(void* ptr) {
+  if (!ptr || IsFromBootstrapArena(ptr)) {
+    return;
+  }
+  if (!real_free) {
+    ResolveFunctions();
+  }
+  RecordFree(ptr, malloc_usable_size(ptr));
+  real_free(ptr);
+}
+
+void* calloc(size_t count, size_t size) {
+  if (!real_calloc) {
+    if (resolving) {
+      // The arena is never reused, so it is still zeroed.
+      return AllocateFromBootstrapArena(count * size);
+    }
+    ResolveFunctions();
+  }
+  void* ptr = real_calloc(count, size);
+  RecordAllocation(ptr, count * size);
+  return ptr;
+}
+
+void* realloc(void* ptr, size_t size) {
+  if (IsFromBootstrapArena(ptr)) {
+    void* result = malloc(size);
+    if (result) {
+      size_t available = bootstrap_arena + sizeof(bootstrap_arena) -
+                         static_cast<char*>(ptr);
+      memcpy(result, ptr, size < available ? size : available);
+    }
+    return result;
+  }
+  if (!real_realloc) {
+    ResolveFunctions();
+  }
+  size_t usable_size = ptr ? malloc_usable_size(ptr) : 0;
+  void* result = real_realloc(ptr, size);
+  // Failed realloc() leaves the block allocated, while realloc() to 0 bytes
+  // frees it.
+  if (ptr && (result || size == 0)) {
+    RecordFree(ptr, usable_size);
+  }
+  RecordAllocation(result, size);
+  return result;
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size) {
+  if (!real_posix_memalign) {
+    ResolveFunctions();
+  }
+  int result = real_posix_memalign(ptr, alignment, size);
+  if (result == 0) {
+    RecordAllocation(*ptr, size);
+  }
+  return result;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+  if (!real_aligned_alloc) {
+    ResolveFunctions();
+  }
+  void* ptr = real_aligned_alloc(alignment, size);
+  RecordAllocation(ptr, size);
+  return ptr;
+}
+
+void* memalign(size_t alignment, size_t size) {
+  if (!real_memalign) {
+    ResolveFunctions();
+  }
+  void* ptr = real_memalign(alignment, size);
+  RecordAllocation(ptr, size);
+  return ptr;
+}
+}
@@ -0,0 +1,48 @@
+import QtQuick
+import QtQuick.Controls
+import QtQuick.Layouts
+import "." as Cdt
+import cdt
+
+SplitView {
+  id: root
+  anchors.fill: parent
+  handle: Cdt.SplitViewHandle {
+    viewId: "AllocationProfile"
+    view: root
+  }
+  AllocationProfileModel {
+    id: profileModel
+  }
+  ColumnLayout {
+    SplitView.minimumWidth: 300
+    SplitView.fillHeight: true
+    spacing: 0
+    Cdt.Pane {
+      Layout.fillWidth: true
+      padding: Theme.basePadding
+      visible: profileModel.summary
+      Cdt.Text {
+        width: parent.width
+        text: profileModel.summary
+        color: Theme.colorPlaceholder
+        wrapMode: Text.WordWrap
+      }
+    }
+    Cdt.SearchableTextList {
+      id: siteList
+      Layout.fillWidth: true
+      Layout.fillHeight: true
+      searchPlaceholderText: "Search call site"
+      searchableModel: profileModel
+      focus: true
+      KeyNavigation.right: stackArea
+    }
+  }
+  Cdt.BigTextArea {
+    id: stackArea
+    SplitView.fillWidth: true
+    SplitView.fillHeight: true
+    text: profileModel.selectedStack
+  }
+}
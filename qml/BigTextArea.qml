@@ -9,20 +9,32 @@ import cdt
 Cdt.Pane {
   id: root
   property string text: ""
+  property var buffer
+  property var lineTimes
   property bool highlightCurrentLineWithoutFocus: false
   property bool monoFont: true
   property alias cursorFollowEnd: textModel.cursorFollowEnd
   property alias cursorPosition: textModel.cursorPosition
   property alias currentLine: listView.currentIndex
   property bool displayLineNumbers: false
+  property bool displayTimeGaps: false
   property list<QtObject> formatters: []
   property var additionalMenuItems: []
   signal preHighlight()
+  signal preHighlightAppended(string text)
   onTextChanged: {
-    searchBar.text = text;
     preHighlight();
     textModel.text = text;
   }
+  onLineTimesChanged: textModel.lineTimes = lineTimes
+  onBufferChanged: textModel.buffer = buffer
+  function appendText(text) {
+    preHighlightAppended(text);
+    textModel.appendText(text);
+  }
+  function appendLineTimes(firstLine, times) {
+    textModel.appendLineTimes(firstLine, times);
+  }
   onActiveFocusChanged: {
     if (!activeFocus) {
       textModel.resetSelection();
@@ -34,12 +46,25 @@ Cdt.Pane {
   function rehighlightLine(line) {
     textModel.rehighlightLines(line, line);
   }
+  function rehighlight() {
+    textModel.rehighlight();
+  }
+  function goToLargestTimeGap() {
+    textModel.goToLargestTimeGap();
+  }
   BigTextAreaModel {
     id: textModel
     onGoToLine: function(line) {
       listView.currentIndex = line;
       listView.positionViewAtIndex(listView.currentIndex, ListView.Center);
     }
+    onTextExtended: offset => searchBar.searchAppendedText(textModel.buffer, offset)
+  }
+  TextMetrics {
+    id: timeGapMetrics
+    font.family: monoFontFamily
+    font.pointSize: monoFontSize
+    text: "+999.9s"
   }
   Keys.onEscapePressed: function(e) {
     e.accepted = textModel.resetSelection() || searchBar.close();
@@ -51,6 +76,11 @@ Cdt.Pane {
       id: searchBar
       Layout.fillWidth: true
       readOnly: true
+      onVisibleChanged: {
+        if (visible) {
+          text = textModel.buffer;
+        }
+      }
       onSearchResultsChanged: textModel.rehighlight()
       onSelectResult: (o, l) => textModel.selectSearchResult(o, l)
       KeyNavigation.down: visible ? listView : null
@@ -85,6 +115,9 @@ Cdt.Pane {
         monoFont: root.monoFont
         formatters: [...root.formatters, searchBar.formatter, textModel.selectionFormatter]
         displayLineNumber: root.displayLineNumbers
+        timeGap: model.timeGap
+        timeGapWidth: timeGapMetrics.width
+        displayTimeGap: root.displayTimeGaps
         enabled: root.enabled
         width: listView.width
         color: ListView.isCurrentItem && (root.highlightCurrentLineWithoutFocus || listView.activeFocus) ? Theme.colorCurrentLine : "transparent"
@@ -0,0 +1,57 @@
+import QtQuick
+import QtQuick.Layouts
+import Qt.labs.platform
+import "." as Cdt
+import cdt
+
+ColumnLayout {
+  anchors.fill: parent
+  spacing: 0
+  CmakeProfileController {
+    id: controller
+  }
+  Cdt.Pane {
+    Layout.fillWidth: true
+    padding: Theme.basePadding
+    visible: controller.summary
+    Cdt.Text {
+      width: parent.width
+      text: controller.summary
+      color: Theme.colorPlaceholder
+    }
+  }
+  Cdt.TableView {
+    id: table
+    Layout.fillWidth: true
+    Layout.fillHeight: true
+    model: controller.table
+    focus: true
+    onHeaderClicked: column => controller.sortBy(column)
+  }
+  Menu {
+    MenuItem {
+      text: "Sort By Name"
+      enabled: table.activeFocus
+      shortcut: gSC("CmakeProfile", "Sort By Name")
+      onTriggered: controller.sortBy(0)
+    }
+    MenuItem {
+      text: "Sort By Time"
+      enabled: table.activeFocus
+      shortcut: gSC("CmakeProfile", "Sort By Time")
+      onTriggered: controller.sortBy(2)
+    }
+    MenuItem {
+      text: "Sort By Self Time"
+      enabled: table.activeFocus
+      shortcut: gSC("CmakeProfile", "Sort By Self Time")
+      onTriggered: controller.sortBy(3)
+    }
+    MenuItem {
+      text: "Sort By Calls"
+      enabled: table.activeFocus
+      shortcut: gSC("CmakeProfile", "Sort By Calls")
+      onTriggered: controller.sortBy(4)
+    }
+  }
+}
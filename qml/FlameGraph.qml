@@ -0,0 +1,107 @@
+import QtQuick
+import QtQuick.Controls
+import QtQuick.Layouts
+import Qt.labs.platform
+import "." as Cdt
+import cdt
+
+ColumnLayout {
+  property int frameHeight: 20
+  anchors.fill: parent
+  spacing: 0
+  FlameGraphController {
+    id: controller
+  }
+  Cdt.Pane {
+    Layout.fillWidth: true
+    padding: Theme.basePadding
+    RowLayout {
+      width: parent.width
+      spacing: Theme.basePadding
+      Cdt.TextField {
+        id: filterTextField
+        placeholderText: "Search function"
+        Layout.fillWidth: true
+        onDisplayTextChanged: controller.setFilter(displayText)
+        KeyNavigation.right: resetZoomBtn
+        KeyNavigation.down: graph
+      }
+      Cdt.Button {
+        id: resetZoomBtn
+        text: "Reset Zoom"
+        enabled: controller.isZoomed
+        onClicked: controller.resetZoom()
+        KeyNavigation.down: graph
+      }
+    }
+  }
+  Cdt.Text {
+    Layout.fillWidth: true
+    Layout.margins: Theme.basePadding
+    visible: !controller.placeholderText
+    text: controller.details
+    elide: Text.ElideRight
+    color: Theme.colorPlaceholder
+  }
+  Cdt.PlaceholderText {
+    Layout.fillWidth: true
+    Layout.fillHeight: true
+    visible: controller.placeholderText
+    text: controller.placeholderText
+  }
+  Flickable {
+    id: graph
+    Layout.fillWidth: true
+    Layout.fillHeight: true
+    visible: !controller.placeholderText
+    focus: true
+    clip: true
+    contentHeight: controller.depth * frameHeight
+    boundsBehavior: Flickable.StopAtBounds
+    ScrollBar.vertical: ScrollBar {}
+    Keys.onEscapePressed: controller.zoomOut()
+    Repeater {
+      model: controller.frames
+      delegate: Rectangle {
+        x: modelData.x * graph.width
+        y: modelData.depth * frameHeight
+        width: Math.max(modelData.width * graph.width - 1, 1)
+        height: frameHeight - 1
+        color: modelData.highlighted ? Theme.colorPrimary : modelData.color
+        Text {
+          anchors.fill: parent
+          anchors.leftMargin: 2
+          visible: parent.width > 20
+          text: modelData.name
+          elide: Text.ElideRight
+          verticalAlignment: Text.AlignVCenter
+          color: modelData.highlighted ? Theme.colorText : "black"
+          renderType: Text.NativeRendering
+        }
+        MouseArea {
+          anchors.fill: parent
+          hoverEnabled: true
+          onEntered: controller.selectFrame(modelData.index)
+          onClicked: {
+            graph.forceActiveFocus();
+            controller.zoomIn(modelData.index);
+          }
+        }
+      }
+    }
+  }
+  Menu {
+    MenuItem {
+      text: "Zoom Out"
+      enabled: graph.activeFocus
+      shortcut: gSC("FlameGraph", "Zoom Out")
+      onTriggered: controller.zoomOut()
+    }
+    MenuItem {
+      text: "Reset Zoom"
+      enabled: graph.activeFocus
+      shortcut: gSC("FlameGraph", "Reset Zoom")
+      onTriggered: controller.resetZoom()
+    }
+  }
+}
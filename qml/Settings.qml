@@ -58,6 +58,96 @@ Loader {
               }
               onDisplayTextChanged: controller.settings.taskHistoryLimit = displayText
               Layout.fillWidth: true
+              KeyNavigation.down: taskOutputRefreshIntervalInput
+            }
+            Cdt.Text {
+              text: "Task Output Refresh Interval (ms)"
+              Layout.minimumWidth: 200
+            }
+            Cdt.TextField {
+              id: taskOutputRefreshIntervalInput
+              text: controller.settings.taskOutputRefreshInterval
+              validator: IntValidator {
+                bottom: 0
+                top: 1000
+              }
+              onDisplayTextChanged: controller.settings.taskOutputRefreshInterval = displayText
+              Layout.fillWidth: true
+              KeyNavigation.down: taskOutputSpillThresholdInput
+            }
+            Cdt.Text {
+              text: "Move Task Output To Disk After (MB)"
+              Layout.minimumWidth: 200
+            }
+            Cdt.TextField {
+              id: taskOutputSpillThresholdInput
+              text: controller.settings.taskOutputSpillThreshold
+              validator: IntValidator {
+                bottom: 0
+                top: 1024
+              }
+              onDisplayTextChanged: controller.settings.taskOutputSpillThreshold = displayText
+              Layout.fillWidth: true
+              KeyNavigation.down: taskOutputHeadLimitInput
+            }
+            Cdt.Text {
+              text: "Keep First Task Output (MB)"
+              Layout.minimumWidth: 200
+            }
+            Cdt.TextField {
+              id: taskOutputHeadLimitInput
+              text: controller.settings.taskOutputHeadLimit
+              validator: IntValidator {
+                bottom: 0
+                top: 512
+              }
+              onDisplayTextChanged: controller.settings.taskOutputHeadLimit = displayText
+              Layout.fillWidth: true
+              KeyNavigation.down: taskOutputTailLimitInput
+            }
+            Cdt.Text {
+              text: "Keep Last Task Output (MB)"
+              Layout.minimumWidth: 200
+            }
+            Cdt.TextField {
+              id: taskOutputTailLimitInput
+              text: controller.settings.taskOutputTailLimit
+              validator: IntValidator {
+                bottom: 0
+                top: 512
+              }
+              onDisplayTextChanged: controller.settings.taskOutputTailLimit = displayText
+              Layout.fillWidth: true
+              KeyNavigation.down: taskJobLimitInput
+            }
+            Cdt.Text {
+              text: "Max Parallel Tasks (0 - CPU Cores)"
+              Layout.minimumWidth: 200
+            }
+            Cdt.TextField {
+              id: taskJobLimitInput
+              text: controller.settings.taskJobLimit
+              validator: IntValidator {
+                bottom: 0
+                top: 256
+              }
+              onDisplayTextChanged: controller.settings.taskJobLimit = displayText
+              Layout.fillWidth: true
+              KeyNavigation.down: slowBuildStepThresholdInput
+            }
+            Cdt.Text {
+              text: "Slow Build Step (Seconds, 0 - Off)"
+              Layout.minimumWidth: 200
+            }
+            Cdt.TextField {
+              id: slowBuildStepThresholdInput
+              text: controller.settings.taskSlowBuildStepThreshold
+              validator: IntValidator {
+                bottom: 0
+                top: 3600
+              }
+              onDisplayTextChanged: controller.settings.taskSlowBuildStepThreshold = displayText
+              Layout.fillWidth: true
               KeyNavigation.down: runWithConsoleOnWinCheckBox
             }
             Cdt.Text {
@@ -71,6 +161,19 @@ Loader {
               checked: controller.settings.shouldRunWithConsoleOnWin
               onCheckedChanged: controller.settings.shouldRunWithConsoleOnWin = checked
               Layout.fillWidth: true
+              KeyNavigation.down: runInPtyCheckBox
+            }
+            Cdt.Text {
+              visible: Qt.platform.os === "linux"
+              text: "Run Executables In Pseudo-Terminal"
+              Layout.minimumWidth: 200
+            }
+            Cdt.CheckBox {
+              id: runInPtyCheckBox
+              visible: Qt.platform.os === "linux"
+              checked: controller.settings.shouldRunInPty
+              onCheckedChanged: controller.settings.shouldRunInPty = checked
+              Layout.fillWidth: true
               KeyNavigation.down: configureExternalSearchFoldersBtn
             }
             Cdt.Button {
@@ -6,7 +6,9 @@ import "." as Cdt
 import cdt
 
 QtQuick.FocusScope {
+  id: root
   property alias model: tableView.model
+  signal headerClicked(int column)
   enabled: !tableView.model.placeholderText
   QtQuick.Connections {
     target: tableView.model
@@ -42,6 +44,10 @@ QtQuick.FocusScope {
           border.width: 1
           border.color: Theme.colorBorder
         }
+        QtQuick.MouseArea {
+          anchors.fill: parent
+          onClicked: root.headerClicked(column)
+        }
       }
     }
     QtQuick.TableView {
@@ -8,6 +8,9 @@ ColumnLayout {
   spacing: 0
   TaskExecutionController {
     id: controller
+    onExecutionOutputReloaded: linkLookup.findFileLinksInBuffer(executionOutput)
+    onExecutionOutputAppended: (offset, data) => linkLookup.findFileLinksInWrittenText(offset, data)
+    onExecutionLineTimesAppended: (line, times) => textArea.appendLineTimes(line, times)
   }
   Cdt.Pane {
     Layout.fillWidth: true
@@ -33,9 +36,31 @@ ColumnLayout {
           text: controller.executionStatus
           color: Theme.colorPlaceholder
         }
+        Cdt.Text {
+          Layout.fillWidth: true
+          visible: controller.slowBuildSteps
+          text: controller.slowBuildSteps
+          color: Theme.colorPlaceholder
+        }
       }
     }
   }
+  Rectangle {
+    Layout.fillWidth: true
+    Layout.margins: Theme.basePadding
+    visible: controller.buildProgress >= 0
+    color: Theme.colorBorder
+    height: Theme.basePadding
+    radius: Theme.baseRadius
+    Rectangle {
+      anchors.top: parent.top
+      anchors.bottom: parent.bottom
+      anchors.left: parent.left
+      width: parent.width * Math.max(controller.buildProgress, 0)
+      radius: Theme.baseRadius
+      color: Theme.colorPrimary
+    }
+  }
   Rectangle {
     Layout.fillWidth: true
     height: 1
@@ -44,6 +69,7 @@ ColumnLayout {
   Cdt.FileLinkLookup {
     id: linkLookup
     onRehighlightLine: line => textArea.rehighlightLine(line)
+    onRehighlightAllLines: textArea.rehighlight()
     onLinkInLineSelected: line => textArea.goToLine(line)
   }
   Cdt.BigTextArea {
@@ -51,11 +77,29 @@ ColumnLayout {
     Layout.fillWidth: true
     Layout.fillHeight: true
     focus: true
-    text: controller.executionOutput
+    buffer: controller.executionOutput
+    lineTimes: controller.executionLineTimes
     formatters: [controller.executionFormatter, linkLookup.formatter]
     cursorFollowEnd: true
-    onPreHighlight: linkLookup.findFileLinks(text)
     onCurrentLineChanged: linkLookup.setCurrentLine(currentLine)
-    additionalMenuItems: linkLookup.menuItems
+    additionalMenuItems: [
+      ...linkLookup.menuItems,
+      {
+        separator: true,
+      },
+      {
+        text: "Toggle Time Gaps",
+        shortcut: gSC("TaskExecution", "Toggle Time Gaps"),
+        callback: () => textArea.displayTimeGaps = !textArea.displayTimeGaps,
+      },
+      {
+        text: "Go To Largest Time Gap",
+        shortcut: gSC("TaskExecution", "Go To Largest Time Gap"),
+        callback: () => {
+          textArea.cursorFollowEnd = false;
+          textArea.goToLargestTimeGap();
+        },
+      },
+    ]
   }
 }
@@ -36,6 +36,30 @@ Cdt.SearchableTextList {
       shortcut: gSC("TaskExecutionList", "Open as Google Test")
       onTriggered: viewSystem.currentView = "GtestExecution.qml"
     }
+    MenuItem {
+      text: "Open Time Trace Report"
+      enabled: execList.activeFocus
+      shortcut: gSC("TaskExecutionList", "Open Time Trace Report")
+      onTriggered: viewSystem.currentView = "TimeTraceReport.qml"
+    }
+    MenuItem {
+      text: "Open CMake Profile"
+      enabled: execList.activeFocus
+      shortcut: gSC("TaskExecutionList", "Open CMake Profile")
+      onTriggered: viewSystem.currentView = "CmakeProfile.qml"
+    }
+    MenuItem {
+      text: "Open Flame Graph"
+      enabled: execList.activeFocus
+      shortcut: gSC("TaskExecutionList", "Open Flame Graph")
+      onTriggered: viewSystem.currentView = "FlameGraph.qml"
+    }
+    MenuItem {
+      text: "Open Allocation Profile"
+      enabled: execList.activeFocus
+      shortcut: gSC("TaskExecutionList", "Open Allocation Profile")
+      onTriggered: viewSystem.currentView = "AllocationProfile.qml"
+    }
     MenuItem {
       text: "Re-Run"
       enabled: execList.activeFocus
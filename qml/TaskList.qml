@@ -27,6 +27,28 @@ Loader {
           text: "Run"
           onTriggered: listModel.executeCurrentTask(false, "TaskExecution.qml", [])
         }
+        MenuItem {
+          text: "Run With Profiling"
+          shortcut: gSC("TaskList", "Run With Profiling")
+          onTriggered: listModel.executeCurrentTaskWithProfiling()
+        }
+        MenuItem {
+          text: "Run With Counters"
+          visible: Qt.platform.os === "linux"
+          shortcut: gSC("TaskList", "Run With Counters")
+          onTriggered: listModel.executeCurrentTaskWithCounters()
+        }
+        MenuItem {
+          text: "Run With Allocation Profiling"
+          visible: Qt.platform.os === "linux"
+          shortcut: gSC("TaskList", "Run With Allocation Profiling")
+          onTriggered: listModel.executeCurrentTaskWithAllocationProfiling()
+        }
+        MenuItem {
+          text: "Run On Changes"
+          shortcut: gSC("TaskList", "Run On Changes")
+          onTriggered: listModel.executeCurrentTaskOnChanges()
+        }
         MenuItem {
           text: "Run as QtTest"
           shortcut: gSC("TaskList", "Run as QtTest")
@@ -37,6 +59,10 @@ Loader {
           shortcut: gSC("TaskList", "Run as QtTest With Filter")
           onTriggered: root.sourceComponent = qtestFilterView
         }
+        MenuItem {
+          text: "Run as QtTest In Parallel"
+          onTriggered: listModel.executeCurrentTaskAsQtestInParallel()
+        }
         MenuItem {
           text: "Run as Google Test"
           shortcut: gSC("TaskList", "Run as Google Test")
@@ -47,11 +73,19 @@ Loader {
           shortcut: gSC("TaskList", "Run as Google Test With Filter")
           onTriggered: root.sourceComponent = gtestFilterView
         }
+        MenuItem {
+          text: "Run as Google Test In Shards"
+          onTriggered: listModel.executeCurrentTaskAsGtestInShards()
+        }
         MenuItem {
           text: "Run Until Fails"
           shortcut: gSC("TaskList", "Run Until Fails")
           onTriggered: listModel.executeCurrentTask(true, "TaskExecution.qml", [])
         }
+        MenuItem {
+          text: "Run Until Fails In Parallel"
+          onTriggered: listModel.executeCurrentTaskUntilFailInParallel()
+        }
         MenuItem {
           text: "Run as QtTest Until Fails"
           shortcut: gSC("TaskList", "Run as QtTest Until Fails")
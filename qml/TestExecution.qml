@@ -88,8 +88,15 @@ ColumnLayout {
       formatters: [linkLookup.formatter]
       cursorFollowEnd: true
       onPreHighlight: linkLookup.findFileLinks(text)
+      onPreHighlightAppended: appended => linkLookup.findFileLinksInAppendedText(appended)
       onCurrentLineChanged: linkLookup.setCurrentLine(currentLine)
       additionalMenuItems: linkLookup.menuItems
+      Connections {
+        target: testModel
+        function onSelectedTestOutputAppended(output) {
+          testOutput.appendText(output);
+        }
+      }
     }
   }
 }
@@ -12,6 +12,9 @@ Cdt.Pane {
   property var lineNumber: null
   property list<QtObject> formatters: []
   property bool displayLineNumber: true
+  property string timeGap: ""
+  property real timeGapWidth: 0
+  property bool displayTimeGap: false
   property bool monoFont: true
   property string lineColor: "transparent"
   signal inlineSelect(int line, int startOffset, int endOffset)
@@ -38,6 +41,18 @@ Cdt.Pane {
       font.family: root.monoFont ? monoFontFamily : null
       font.pointSize: root.monoFont ? monoFontSize : -1
     }
+    Cdt.Text {
+      visible: root.displayTimeGap
+      text: root.timeGap
+      color: Theme.colorPlaceholder
+      Layout.fillHeight: true
+      Layout.minimumWidth: root.timeGapWidth
+      Layout.leftMargin: Theme.basePadding
+      horizontalAlignment: Text.AlignRight
+      verticalAlignment: Text.AlignTop
+      font.family: monoFontFamily
+      font.pointSize: monoFontSize
+    }
     Cdt.Pane {
       Layout.leftMargin: Theme.basePadding
       Layout.rightMargin: Theme.basePadding
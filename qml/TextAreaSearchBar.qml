@@ -5,19 +5,29 @@ import cdt
 
 Cdt.TextSearchBar {
   id: root
-  property string text: ""
+  // Either a string or a buffer of BigTextArea.
+  property var text: ""
+  property bool appendingText: false
   property alias formatter: controller.formatter
   signal searchResultsChanged()
   signal selectResult(int offset, int length)
   signal replaceResults(list<int> offsets, list<int> lengths, string text)
   onTextChanged: {
-    if (visible) {
+    if (visible && !appendingText) {
       controller.search(searchTerm, text, root.activeFocus, false)
     }
   }
   onSearch: controller.search(searchTerm, root.text, true, true)
   onReplace: replaceAll => controller.replaceSearchResultWith(replacementTerm, replaceAll)
   onGoToSearchResult: next => controller.goToSearchResult(next)
+  function searchAppendedText(text, offset) {
+    appendingText = true;
+    root.text = text;
+    appendingText = false;
+    if (visible) {
+      controller.searchAppended(searchTerm, text, offset);
+    }
+  }
   function displayAndGoToResult(offset, text) {
     display(text);
     controller.goToResultWithStartAt(offset);
@@ -0,0 +1,13 @@
+import QtQuick
+import "." as Cdt
+import cdt
+
+Cdt.SearchableTextList {
+  anchors.fill: parent
+  searchPlaceholderText: "Search header, template or function"
+  searchableModel: reportModel
+  focus: true
+  TimeTraceReportModel {
+    id: reportModel
+  }
+}
@@ -0,0 +1,217 @@
+#include "allocation_profile.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocale>
+#include <QProcess>
+#include <QSet>
+#include <algorithm>
+
+#define LOG() qDebug() << "[AllocationProfile]"
+
+static const QStringList kAllocatorFramePrefixes = {
+    "operator new",
+    "std::allocator",
+    "std::__new_allocator",
+    "__gnu_cxx::new_allocator",
+};
+
+QString AllocationSite::GetCaller() const {
+  for (const QString& frame : frames) {
+    bool is_allocator = false;
+    for (const QString& prefix : kAllocatorFramePrefixes) {
+      if (frame.startsWith(prefix)) {
+        is_allocator = true;
+        break;
+      }
+    }
+    if (!is_allocator) {
+      return frame;
+    }
+  }
+  return frames.isEmpty() ? "[unknown]" : frames.first();
+}
+
+QString AllocationProfile::GetLibraryPath() {
+  return QCoreApplication::applicationDirPath() + "/libcdt-alloc-profiler.so";
+}
+
+struct RawFrame {
+  QString offset;
+  QString module;
+  QString symbol;
+};
+
+struct RawSite {
+  AllocationSite site;
+  QList<RawFrame> frames;
+};
+
+// Returns names of functions, that the specified offsets of the module belong
+// to, which are "??" when addr2line can't find them.
+static QStringList Addr2Line(const QString& module,
+                             const QStringList& offsets) {
+  QProcess proc;
+  proc.setStandardErrorFile(QProcess::nullDevice());
+  proc.start("addr2line", QStringList{"-C", "-f", "-e", module} + offsets);
+  if (!proc.waitForFinished(-1) || proc.exitCode() != 0) {
+    LOG() << "Failed to symbolize frames of" << module << proc.errorString();
+    return {};
+  }
+  // Each address is printed as a line with the function, followed by a line
+  // with its location in the source code.
+  QStringList functions;
+  QList<QByteArray> lines = proc.readAllStandardOutput().split('\n');
+  for (int i = 0; i + 1 < lines.size(); i += 2) {
+    functions.append(QString::fromUtf8(lines[i]));
+  }
+  return functions;
+}
+
+static void SymbolizeFrames(QList<RawSite>& sites) {
+  QHash<QString, QSet<QString>> unknown_offsets_by_module;
+  for (const RawSite& site : sites) {
+    for (const RawFrame& frame : site.frames) {
+      if (frame.symbol.isEmpty() && !frame.module.isEmpty()) {
+        unknown_offsets_by_module[frame.module].insert(frame.offset);
+      }
+    }
+  }
+  QHash<QString, QString> symbols;
+  for (auto it = unknown_offsets_by_module.begin();
+       it != unknown_offsets_by_module.end(); it++) {
+    QStringList offsets = it.value().values();
+    QStringList functions = Addr2Line(it.key(), offsets);
+    for (int i = 0; i < std::min(offsets.size(), functions.size()); i++) {
+      if (functions[i] != "??") {
+        symbols[it.key() + '\t' + offsets[i]] = functions[i];
+      }
+    }
+  }
+  for (RawSite& site : sites) {
+    for (const RawFrame& frame : site.frames) {
+      QString symbol = frame.symbol;
+      if (symbol.isEmpty()) {
+        symbol = symbols.value(frame.module + '\t' + frame.offset);
+      }
+      if (symbol.isEmpty()) {
+        symbol = frame.module.isEmpty()
+                     ? frame.offset
+                     : QFileInfo(frame.module).fileName() + '+' + frame.offset;
+      }
+      site.site.frames.append(symbol);
+    }
+  }
+}
+
+AllocationProfile AllocationProfile::ParseSync(const QString& path,
+                                               int limit) {
+  LOG() << "Parsing allocation profile" << path;
+  AllocationProfile profile;
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    LOG() << "Failed to open" << path << file.errorString();
+    return profile;
+  }
+  // Each line is a tab-separated record: totals of the process, followed by
+  // call sites, each of which is followed by its frames.
+  QList<RawSite> sites;
+  while (!file.atEnd()) {
+    QList<QByteArray> fields = file.readLine().trimmed().split('\t');
+    if (fields[0] == "sample_interval" && fields.size() >= 2) {
+      profile.sample_interval = fields[1].toInt();
+    } else if (fields[0] == "total" && fields.size() >= 4) {
+      profile.allocations = fields[1].toLongLong();
+      profile.bytes = fields[2].toLongLong();
+      profile.peak_heap_size = fields[3].toLongLong();
+    } else if (fields[0] == "site" && fields.size() >= 4) {
+      RawSite site;
+      site.site.allocations = fields[1].toLongLong();
+      site.site.bytes = fields[2].toLongLong();
+      site.site.peak_bytes = fields[3].toLongLong();
+      sites.append(site);
+    } else if (fields[0] == "frame" && fields.size() >= 2 &&
+               !sites.isEmpty()) {
+      RawFrame frame;
+      frame.offset = QString::fromUtf8(fields[1]);
+      frame.module = QString::fromUtf8(fields.value(2));
+      frame.symbol = QString::fromUtf8(fields.value(3));
+      sites.last().frames.append(frame);
+    }
+  }
+  std::sort(sites.begin(), sites.end(), [](const RawSite& a, const RawSite& b) {
+    return a.site.bytes > b.site.bytes;
+  });
+  sites = sites.mid(0, std::min(limit, static_cast<int>(sites.size())));
+  SymbolizeFrames(sites);
+  for (const RawSite& site : sites) {
+    profile.sites.append(site.site);
+  }
+  LOG() << "Parsed" << profile.allocations << "allocations of"
+        << profile.sites.size() << "call sites";
+  return profile;
+}
+
+AllocationProfile AllocationProfile::Deserialize(const QByteArray& bytes) {
+  AllocationProfile profile;
+  QJsonObject o = QJsonDocument::fromJson(qUncompress(bytes)).object();
+  profile.allocations = o["allocations"].toInteger();
+  profile.bytes = o["bytes"].toInteger();
+  profile.peak_heap_size = o["peak_heap_size"].toInteger();
+  profile.sample_interval = o["sample_interval"].toInt();
+  for (const QJsonValue& value : o["sites"].toArray()) {
+    QJsonObject s = value.toObject();
+    AllocationSite site;
+    site.allocations = s["allocations"].toInteger();
+    site.bytes = s["bytes"].toInteger();
+    site.peak_bytes = s["peak_bytes"].toInteger();
+    for (const QJsonValue& frame : s["frames"].toArray()) {
+      site.frames.append(frame.toString());
+    }
+    profile.sites.append(site);
+  }
+  return profile;
+}
+
+QByteArray AllocationProfile::Serialize() const {
+  QJsonArray sites_array;
+  for (const AllocationSite& site : sites) {
+    QJsonObject s;
+    s["allocations"] = site.allocations;
+    s["bytes"] = site.bytes;
+    s["peak_bytes"] = site.peak_bytes;
+    s["frames"] = QJsonArray::fromStringList(site.frames);
+    sites_array.append(s);
+  }
+  QJsonObject o;
+  o["allocations"] = allocations;
+  o["bytes"] = bytes;
+  o["peak_heap_size"] = peak_heap_size;
+  o["sample_interval"] = sample_interval;
+  o["sites"] = sites_array;
+  // Frames of C++ code tend to be long and repetitive.
+  return qCompress(QJsonDocument(o).toJson(QJsonDocument::Compact));
+}
+
+bool AllocationProfile::IsNull() const { return allocations == 0; }
+
+static QString FormatBytes(qint64 bytes) {
+  return QLocale::c().formattedDataSize(bytes, 1,
+                                        QLocale::DataSizeTraditionalFormat);
+}
+
+QString AllocationProfile::FormatReport() const {
+  QString result = "\nHeap allocations:\n";
+  result += "  Allocations: " + QLocale::system().toString(allocations) + '\n';
+  result += "  Allocated: " + FormatBytes(bytes) + '\n';
+  result += "  Peak heap size: " + FormatBytes(peak_heap_size) + '\n';
+  result += QString::number(sites.size()) +
+            " top allocating call sites are available in the allocation "
+            "profile\n";
+  return result;
+}
@@ -0,0 +1,47 @@
+#ifndef ALLOCATIONPROFILE_H
+#define ALLOCATIONPROFILE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+struct AllocationSite {
+  // First frame, that is not a part of an allocator.
+  QString GetCaller() const;
+
+  qint64 allocations = 0;
+  qint64 bytes = 0;
+  // Largest amount of memory, that allocations of the site have held at once.
+  qint64 peak_bytes = 0;
+  // From the caller of the allocating function to the root.
+  QStringList frames;
+};
+
+/**
+ * Heap allocations of a process, collected by the allocation profiler library,
+ * that gets preloaded into the process. Totals of the process are exact,
+ * while allocations of its call sites are estimated from sampled backtraces.
+ */
+struct AllocationProfile {
+  // The library is built together with the app and is placed next to it.
+  static QString GetLibraryPath();
+  // Frames, that the library could not symbolize itself, get symbolized with
+  // addr2line, which can take a while, so it should not be called on the IO
+  // thread. Only the sites, that have allocated the most, are kept.
+  static AllocationProfile ParseSync(const QString& path, int limit);
+  static AllocationProfile Deserialize(const QByteArray& bytes);
+  QByteArray Serialize() const;
+  bool IsNull() const;
+  QString FormatReport() const;
+
+  qint64 allocations = 0;
+  qint64 bytes = 0;
+  qint64 peak_heap_size = 0;
+  // Backtrace of each N-th allocation of a thread has been sampled.
+  int sample_interval = 0;
+  // Sorted by allocated bytes, from the largest.
+  QList<AllocationSite> sites;
+};
+
+#endif  // ALLOCATIONPROFILE_H
@@ -0,0 +1,72 @@
+#include "allocation_profile_model.h"
+
+#include <QLocale>
+
+#include "application.h"
+
+#define LOG() qDebug() << "[AllocationProfileModel]"
+
+static QString FormatBytes(qint64 bytes) {
+  return QLocale::c().formattedDataSize(bytes, 1,
+                                        QLocale::DataSizeTraditionalFormat);
+}
+
+AllocationProfileModel::AllocationProfileModel(QObject* parent)
+    : TextListModel(parent) {
+  SetRoleNames({{0, "title"}, {1, "subTitle"}, {2, "rightText"}});
+  searchable_roles = {0};
+  SetEmptyListPlaceholder(
+      "Execution has not been profiled. Run an executable with allocation "
+      "profiling to see where it allocates memory.");
+  Application& app = Application::Get();
+  app.view.SetWindowTitle("Allocation Profile");
+  // Profile of a running execution becomes available once it finishes.
+  connect(&app.task, &TaskSystem::executionFinished, this, [this](QUuid id) {
+    if (id == execution_id) {
+      load();
+    }
+  });
+  load();
+}
+
+QString AllocationProfileModel::GetSelectedStack() const {
+  int i = GetSelectedItemIndex();
+  return i < 0 ? "" : profile.sites[i].frames.join('\n');
+}
+
+void AllocationProfileModel::load() {
+  Application& app = Application::Get();
+  execution_id = app.task.GetSelectedExecutionId();
+  LOG() << "Loading allocation profile of execution" << execution_id;
+  if (const TaskExecution* exec = app.task.FindExecutionById(execution_id)) {
+    SetPlaceholder("Profiling allocations of " + exec->task_name + "...");
+    return;
+  }
+  SetPlaceholder("Loading allocation profile...");
+  app.task.FetchAllocationProfile(execution_id)
+      .Then(this, [this](const AllocationProfile& result) {
+        profile = result;
+        summary.clear();
+        if (!profile.IsNull()) {
+          summary = QLocale::system().toString(profile.allocations) +
+                    " allocations, " + FormatBytes(profile.bytes) +
+                    " allocated, peak heap size is " +
+                    FormatBytes(profile.peak_heap_size) +
+                    ". Call sites are estimated from backtraces of 1 in " +
+                    QString::number(profile.sample_interval) +
+                    " allocations.";
+        }
+        emit profileChanged();
+        SetPlaceholder();
+        Load();
+      });
+}
+
+QVariantList AllocationProfileModel::GetRow(int i) const {
+  const AllocationSite& site = profile.sites[i];
+  QString details = QLocale::system().toString(site.allocations) +
+                    " allocations, peak " + FormatBytes(site.peak_bytes);
+  return {site.GetCaller(), details, FormatBytes(site.bytes)};
+}
+
+int AllocationProfileModel::GetRowCount() const { return profile.sites.size(); }
@@ -0,0 +1,38 @@
+#ifndef ALLOCATIONPROFILEMODEL_H
+#define ALLOCATIONPROFILEMODEL_H
+
+#include <QObject>
+#include <QQmlEngine>
+#include <QUuid>
+
+#include "allocation_profile.h"
+#include "text_list_model.h"
+
+class AllocationProfileModel : public TextListModel {
+  Q_OBJECT
+  QML_ELEMENT
+  Q_PROPERTY(QString summary MEMBER summary NOTIFY profileChanged)
+  Q_PROPERTY(
+      QString selectedStack READ GetSelectedStack NOTIFY selectedItemChanged)
+ public:
+  explicit AllocationProfileModel(QObject* parent = nullptr);
+  QString GetSelectedStack() const;
+
+  AllocationProfile profile;
+
+ public slots:
+  void load();
+
+ signals:
+  void profileChanged();
+
+ protected:
+  QVariantList GetRow(int i) const;
+  int GetRowCount() const;
+
+ private:
+  QUuid execution_id;
+  QString summary;
+};
+
+#endif  // ALLOCATIONPROFILEMODEL_H
@@ -0,0 +1,87 @@
+#include "build_progress.h"
+
+#include <QRegularExpression>
+#include <algorithm>
+
+#include "path.h"
+
+static QString FormatDuration(qint64 ms) {
+  qint64 seconds = (ms + 999) / 1000;
+  if (seconds < 60) {
+    return QString::number(seconds) + 's';
+  }
+  return QString::number(seconds / 60) + "m " + QString::number(seconds % 60) +
+         's';
+}
+
+bool BuildProgress::ParseLine(const QString& line, qint64 time) {
+  static const QRegularExpression kNinjaStatus(R"(^\[(\d+)/(\d+)\] )");
+  static const QRegularExpression kMakeStatus(R"(^\[\s*(\d+)%\] )");
+  if (QRegularExpressionMatch m = kNinjaStatus.match(line); m.hasMatch()) {
+    finished = m.captured(1).toInt();
+    total = m.captured(2).toInt();
+    is_percentage = false;
+  } else if (QRegularExpressionMatch m = kMakeStatus.match(line);
+             m.hasMatch()) {
+    finished = m.captured(1).toInt();
+    total = 100;
+    is_percentage = true;
+  } else {
+    return false;
+  }
+  last_time = time;
+  return true;
+}
+
+void BuildProgress::AddSlowStep(const QString& output, qint64 duration) {
+  Step step{output, duration};
+  auto it = std::upper_bound(
+      slow_steps.begin(), slow_steps.end(), step,
+      [](const Step& a, const Step& b) { return a.duration > b.duration; });
+  slow_steps.insert(it, step);
+}
+
+bool BuildProgress::IsNull() const { return total <= 0; }
+
+double BuildProgress::GetProgress() const {
+  return IsNull() ? 0 : std::min(1.0, static_cast<double>(finished) / total);
+}
+
+qint64 BuildProgress::GetEta() const {
+  if (finished <= 0 || last_time <= 0) {
+    return -1;
+  }
+  return last_time * std::max(total - finished, 0) / finished;
+}
+
+QList<std::pair<QString, QString>> BuildProgress::GetStats() const {
+  QList<std::pair<QString, QString>> stats;
+  if (IsNull()) {
+    return stats;
+  }
+  if (is_percentage) {
+    stats.append({"Built", QString::number(finished) + '%'});
+  } else {
+    stats.append({"Built", QString::number(finished) + " / " +
+                               QString::number(total)});
+  }
+  if (qint64 eta = GetEta(); eta >= 0 && finished < total) {
+    stats.append({"ETA", FormatDuration(eta)});
+  }
+  return stats;
+}
+
+QString BuildProgress::FormatSlowSteps(int limit) const {
+  QStringList steps;
+  for (int i = 0; i < std::min(limit, static_cast<int>(slow_steps.size()));
+       i++) {
+    const Step& step = slow_steps[i];
+    steps.append(Path::GetFileName(step.output) + ": <b>" +
+                 FormatDuration(step.duration) + "</b>");
+  }
+  if (slow_steps.size() > limit) {
+    steps.append("and " + QString::number(slow_steps.size() - limit) +
+                 " more");
+  }
+  return steps.join("&nbsp;&nbsp;&nbsp;");
+}
@@ -0,0 +1,39 @@
+#ifndef BUILDPROGRESS_H
+#define BUILDPROGRESS_H
+
+#include <QList>
+#include <QString>
+
+/**
+ * Progress of a running build, that is parsed from the output of its build
+ * tool, and steps of the build, that have taken too long. Ninja prefixes each
+ * step it finishes with "[<finished>/<total>]", while Make prefixes each step
+ * with "[<percent>%]". Times are in milliseconds since the start of the
+ * build.
+ */
+struct BuildProgress {
+  struct Step {
+    QString output;
+    qint64 duration = 0;
+  };
+
+  // Returns true if the line is a status line of a build tool.
+  bool ParseLine(const QString& line, qint64 time);
+  void AddSlowStep(const QString& output, qint64 duration);
+  bool IsNull() const;
+  double GetProgress() const;
+  // Estimate of the time left, which is based on how fast steps have been
+  // finishing so far, or -1 when there is nothing to base it on yet.
+  qint64 GetEta() const;
+  QList<std::pair<QString, QString>> GetStats() const;
+  QString FormatSlowSteps(int limit) const;
+
+  int finished = 0;
+  int total = 0;
+  bool is_percentage = false;
+  qint64 last_time = 0;
+  // Sorted by duration, from the slowest one.
+  QList<Step> slow_steps;
+};
+
+#endif  // BUILDPROGRESS_H
@@ -0,0 +1,125 @@
+#include "build_report.h"
+
+#include <QDateTime>
+#include <algorithm>
+#include <cstdlib>
+
+#include "database.h"
+
+#define LOG() qDebug() << "[BuildReport]"
+
+// Number of builds (or configures), durations of each step of which are kept.
+static constexpr int kStepHistoryLimit = 20;
+
+static QString FormatDuration(qint64 ms) {
+  return QString::number(ms / 1000.0, 'f', 1) + 's';
+}
+
+BuildReport BuildReport::CreateSync(QUuid project_id,
+                                    const QString& build_folder,
+                                    const QList<NinjaLogEntry>& entries,
+                                    int limit) {
+  BuildReport report;
+  report.step_count = entries.size();
+  if (entries.isEmpty()) {
+    return report;
+  }
+  LOG() << "Creating report of" << entries.size() << "steps of build in"
+        << build_folder;
+  QList<NinjaLogEntry> slowest = entries;
+  std::sort(slowest.begin(), slowest.end(),
+            [](const NinjaLogEntry& a, const NinjaLogEntry& b) {
+              return a.GetDuration() > b.GetDuration();
+            });
+  slowest.resize(std::min(limit, static_cast<int>(slowest.size())));
+  for (const NinjaLogEntry& entry : slowest) {
+    BuildStep step;
+    step.output = entry.output;
+    step.duration = entry.GetDuration();
+    QList<int> durations = Database::ExecQueryAndRead<int>(
+        "SELECT duration FROM build_step WHERE project_id=? AND "
+        "build_folder=? AND output=? ORDER BY build_time DESC LIMIT 1",
+        &Database::ReadIntFromSql, {project_id, build_folder, entry.output});
+    if (!durations.isEmpty()) {
+      step.previous_duration = durations.constFirst();
+    }
+    report.slowest_steps.append(step);
+  }
+  QDateTime build_time = QDateTime::currentDateTime();
+  Database::Transaction t;
+  for (const NinjaLogEntry& entry : entries) {
+    Database::ExecCmd("INSERT INTO build_step VALUES(?,?,?,?,?)",
+                      {project_id, build_folder, entry.output, build_time,
+                       entry.GetDuration()});
+    // Only history of steps, that have just been built, can grow, so only
+    // it gets trimmed. Both lookups are served by the build_step_output
+    // index.
+    Database::ExecCmd(
+        "DELETE FROM build_step WHERE project_id=? AND build_folder=? AND "
+        "output=? AND build_time < (SELECT build_time FROM build_step WHERE "
+        "project_id=? AND build_folder=? AND output=? ORDER BY build_time "
+        "DESC LIMIT 1 OFFSET ?)",
+        {project_id, build_folder, entry.output, project_id, build_folder,
+         entry.output, kStepHistoryLimit - 1});
+  }
+  return report;
+}
+
+bool BuildReport::IsNull() const { return slowest_steps.isEmpty(); }
+
+ConfigureReport ConfigureReport::CreateSync(QUuid project_id,
+                                            const QString& build_path,
+                                            qint64 duration) {
+  ConfigureReport report;
+  report.duration = duration;
+  report.previous_durations = Database::ExecQueryAndRead<qint64>(
+      "SELECT duration FROM cmake_configure WHERE project_id=? AND "
+      "build_path=? ORDER BY configure_time DESC",
+      [](QSqlQuery& sql) { return sql.value(0).toLongLong(); },
+      {project_id, build_path});
+  Database::Transaction t;
+  Database::ExecCmd("INSERT INTO cmake_configure VALUES(?,?,?,?)",
+                    {project_id, build_path, QDateTime::currentDateTime(),
+                     duration});
+  Database::ExecCmd(
+      "DELETE FROM cmake_configure WHERE project_id=? AND build_path=? AND "
+      "configure_time < (SELECT configure_time FROM cmake_configure WHERE "
+      "project_id=? AND build_path=? ORDER BY configure_time DESC LIMIT 1 "
+      "OFFSET ?)",
+      {project_id, build_path, project_id, build_path, kStepHistoryLimit - 1});
+  return report;
+}
+
+QString ConfigureReport::Format() const {
+  QString result = "\nConfigured in " + FormatDuration(duration);
+  if (!previous_durations.isEmpty()) {
+    qint64 previous = previous_durations.constFirst();
+    qint64 change = duration - previous;
+    qint64 sum = 0;
+    for (qint64 d : previous_durations) {
+      sum += d;
+    }
+    result += " (was " + FormatDuration(previous) + ", " +
+              (change >= 0 ? "+" : "-") + FormatDuration(std::abs(change)) +
+              "; average of " + QString::number(previous_durations.size()) +
+              " previous configures is " +
+              FormatDuration(sum / previous_durations.size()) + ')';
+  }
+  return result + '\n';
+}
+
+QString BuildReport::Format() const {
+  QString result = "\nSlowest of " + QString::number(step_count) +
+                   " build steps:\n";
+  for (const BuildStep& step : slowest_steps) {
+    result += "  " + FormatDuration(step.duration) + ' ' + step.output;
+    if (step.previous_duration >= 0) {
+      qint64 change = step.duration - step.previous_duration;
+      result += " (was " + FormatDuration(step.previous_duration) + ", " +
+                (change >= 0 ? "+" : "-") + FormatDuration(std::abs(change)) +
+                ')';
+    }
+    result += '\n';
+  }
+  return result;
+}
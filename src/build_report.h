@@ -0,0 +1,49 @@
+#ifndef BUILDREPORT_H
+#define BUILDREPORT_H
+
+#include <QList>
+#include <QString>
+#include <QUuid>
+
+#include "ninja_log.h"
+
+struct BuildStep {
+  QString output;
+  qint64 duration = 0;
+  // Duration of the same step, when it has been run last time, or -1.
+  qint64 previous_duration = -1;
+};
+
+/**
+ * Slowest steps of a build along with how long they have taken last time.
+ * Steps of all builds are stored in the database, so that a step, that has
+ * suddenly become slower (e.g. because of a header change), stands out.
+ */
+struct BuildReport {
+  // Also stores the steps in the database.
+  static BuildReport CreateSync(QUuid project_id, const QString& build_folder,
+                                const QList<NinjaLogEntry>& entries,
+                                int limit);
+  bool IsNull() const;
+  QString Format() const;
+
+  QList<BuildStep> slowest_steps;
+  int step_count = 0;
+};
+
+/**
+ * How long a configure of a build folder has taken compared to the previous
+ * configures of it. Durations of all configures are stored in the database.
+ */
+struct ConfigureReport {
+  // Also stores the duration in the database.
+  static ConfigureReport CreateSync(QUuid project_id, const QString& build_path,
+                                    qint64 duration);
+  QString Format() const;
+
+  qint64 duration = 0;
+  // Most recent first.
+  QList<qint64> previous_durations;
+};
+
+#endif  // BUILDREPORT_H
@@ -0,0 +1,186 @@
+#include "cmake_profile.h"
+
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+
+#define LOG() qDebug() << "[CmakeProfile]"
+
+QString CmakeProfileEntry::GetKindName(Kind kind) {
+  return kind == kCommand ? "Command" : "File";
+}
+
+struct Call {
+  QString command;
+  QString file;
+  qint64 start = 0;
+  qint64 end = 0;
+};
+
+static QList<Call> ReadCalls(const QJsonArray& events) {
+  QList<Call> calls;
+  // Each thread has calls, that have begun but not yet ended.
+  QHash<QString, QList<Call>> open_calls;
+  for (const QJsonValue& value : events) {
+    QJsonObject event = value.toObject();
+    QString ph = event["ph"].toString();
+    QString thread = event["pid"].toVariant().toString() + ':' +
+                     event["tid"].toVariant().toString();
+    qint64 ts = event["ts"].toInteger();
+    if (ph == "E") {
+      QList<Call>& open = open_calls[thread];
+      if (!open.isEmpty()) {
+        Call call = open.takeLast();
+        call.end = ts;
+        calls.append(call);
+      }
+      continue;
+    }
+    if (ph != "B" && ph != "X") {
+      continue;
+    }
+    Call call;
+    call.command = event["name"].toString();
+    // Location looks like "/path/to/CMakeLists.txt:42".
+    QString location = event["args"].toObject()["location"].toString();
+    call.file = location.left(location.lastIndexOf(':'));
+    call.start = ts;
+    if (ph == "B") {
+      open_calls[thread].append(call);
+    } else {
+      call.end = ts + event["dur"].toInteger();
+      calls.append(call);
+    }
+  }
+  std::sort(calls.begin(), calls.end(), [](const Call& a, const Call& b) {
+    return a.start != b.start ? a.start < b.start : a.end > b.end;
+  });
+  return calls;
+}
+
+typedef QHash<QString, CmakeProfileEntry> CmakeProfileTotals;
+
+static void AddToTotals(CmakeProfileTotals& totals,
+                        CmakeProfileEntry::Kind kind, const QString& name,
+                        qint64 duration, qint64 self_duration,
+                        bool is_nested) {
+  CmakeProfileEntry& entry = totals[name];
+  entry.kind = kind;
+  entry.name = name;
+  entry.self_duration += self_duration;
+  entry.count++;
+  if (!is_nested) {
+    entry.duration += duration;
+  }
+}
+
+CmakeProfile CmakeProfile::ParseSync(const QString& path) {
+  CmakeProfile profile;
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    LOG() << "Failed to open" << path;
+    return profile;
+  }
+  QByteArray data = file.readAll();
+  // CMake does not terminate the trace, if it fails.
+  if (!data.trimmed().endsWith(']')) {
+    data = data.trimmed();
+    if (data.endsWith(',')) {
+      data.chop(1);
+    }
+    data += ']';
+  }
+  QJsonDocument doc = QJsonDocument::fromJson(data);
+  QList<Call> calls =
+      ReadCalls(doc.isArray() ? doc.array() : doc["traceEvents"].toArray());
+  LOG() << "Parsed" << calls.size() << "calls from" << path;
+  CmakeProfileTotals commands, files;
+  struct Frame {
+    const Call* call;
+    qint64 child_duration = 0;
+  };
+  QList<Frame> stack;
+  QHash<QString, int> open_commands, open_files;
+  auto pop = [&] {
+    Frame frame = stack.takeLast();
+    const Call& call = *frame.call;
+    qint64 duration = call.end - call.start;
+    qint64 self_duration = std::max(duration - frame.child_duration, 0LL);
+    int& command_depth = open_commands[call.command];
+    int& file_depth = open_files[call.file];
+    command_depth--;
+    file_depth--;
+    AddToTotals(commands, CmakeProfileEntry::kCommand, call.command, duration,
+                self_duration, command_depth > 0);
+    if (!call.file.isEmpty()) {
+      AddToTotals(files, CmakeProfileEntry::kFile, call.file, duration,
+                  self_duration, file_depth > 0);
+    }
+    if (!stack.isEmpty()) {
+      stack.last().child_duration += duration;
+    } else {
+      profile.duration += duration;
+    }
+  };
+  for (const Call& call : calls) {
+    while (!stack.isEmpty() && stack.last().call->end <= call.start) {
+      pop();
+    }
+    stack.append(Frame{&call});
+    open_commands[call.command]++;
+    open_files[call.file]++;
+  }
+  while (!stack.isEmpty()) {
+    pop();
+  }
+  profile.call_count = calls.size();
+  profile.entries = commands.values() + files.values();
+  std::sort(profile.entries.begin(), profile.entries.end(),
+            [](const CmakeProfileEntry& a, const CmakeProfileEntry& b) {
+              return a.duration > b.duration;
+            });
+  return profile;
+}
+
+CmakeProfile CmakeProfile::Deserialize(const QByteArray& bytes) {
+  CmakeProfile profile;
+  QJsonObject o = QJsonDocument::fromJson(bytes).object();
+  profile.duration = o["duration"].toInteger();
+  profile.call_count = o["call_count"].toInt();
+  for (const QJsonValue& value : o["entries"].toArray()) {
+    QJsonObject e = value.toObject();
+    CmakeProfileEntry entry;
+    entry.kind = e["kind"].toInt() == CmakeProfileEntry::kFile
+                     ? CmakeProfileEntry::kFile
+                     : CmakeProfileEntry::kCommand;
+    entry.name = e["name"].toString();
+    entry.duration = e["duration"].toInteger();
+    entry.self_duration = e["self_duration"].toInteger();
+    entry.count = e["count"].toInt();
+    profile.entries.append(entry);
+  }
+  return profile;
+}
+
+QByteArray CmakeProfile::Serialize() const {
+  QJsonArray entries_array;
+  for (const CmakeProfileEntry& entry : entries) {
+    QJsonObject e;
+    e["kind"] = entry.kind;
+    e["name"] = entry.name;
+    e["duration"] = entry.duration;
+    e["self_duration"] = entry.self_duration;
+    e["count"] = entry.count;
+    entries_array.append(e);
+  }
+  QJsonObject o;
+  o["duration"] = duration;
+  o["call_count"] = call_count;
+  o["entries"] = entries_array;
+  return QJsonDocument(o).toJson(QJsonDocument::Compact);
+}
+
+bool CmakeProfile::IsNull() const { return call_count == 0; }
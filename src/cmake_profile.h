@@ -0,0 +1,44 @@
+#ifndef CMAKEPROFILE_H
+#define CMAKEPROFILE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+struct CmakeProfileEntry {
+  enum Kind {
+    kCommand,
+    kFile,
+  };
+
+  static QString GetKindName(Kind kind);
+
+  Kind kind = kCommand;
+  QString name;
+  // Microseconds. Calls, that are nested into calls of the same command (or
+  // calls from the same file), are not counted twice.
+  qint64 duration = 0;
+  // Microseconds, spent in the calls themselves and not in the calls, that
+  // are nested into them.
+  qint64 self_duration = 0;
+  int count = 0;
+};
+
+/**
+ * Time, that CMake has spent on each command and each listfile while
+ * configuring a project, parsed from a trace, that CMake writes when it is
+ * run with "--profiling-format=google-trace".
+ */
+struct CmakeProfile {
+  static CmakeProfile ParseSync(const QString& path);
+  static CmakeProfile Deserialize(const QByteArray& bytes);
+  QByteArray Serialize() const;
+  bool IsNull() const;
+
+  // Microseconds, spent in top-level calls.
+  qint64 duration = 0;
+  int call_count = 0;
+  QList<CmakeProfileEntry> entries;
+};
+
+#endif  // CMAKEPROFILE_H
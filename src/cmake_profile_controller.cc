@@ -0,0 +1,83 @@
+#include "cmake_profile_controller.h"
+
+#include <algorithm>
+
+#include "application.h"
+
+#define LOG() qDebug() << "[CmakeProfileController]"
+
+static const QStringList kColumns = {"Name", "Kind", "Time", "Self Time",
+                                     "Calls"};
+static constexpr int kTimeColumn = 2;
+
+static QString FormatDuration(qint64 us) {
+  return QString::number(us / 1000000.0, 'f', 3) + 's';
+}
+
+CmakeProfileController::CmakeProfileController(QObject* parent)
+    : QObject(parent),
+      table(new SqliteTableModel(this)),
+      sort_column(kTimeColumn) {
+  Application::Get().view.SetWindowTitle("CMake Profile");
+  load();
+}
+
+void CmakeProfileController::load() {
+  Application& app = Application::Get();
+  QUuid id = app.task.GetSelectedExecutionId();
+  LOG() << "Loading CMake profile of execution" << id;
+  table->SetPlaceholder("Loading CMake profile...");
+  app.task.FetchCmakeProfile(id).Then(this, [this](const CmakeProfile& result) {
+    profile = result;
+    if (profile.IsNull()) {
+      summary.clear();
+      table->SetPlaceholder(
+          "CMake has not been profiled. Run CMake task with profiling to "
+          "profile it.");
+    } else {
+      summary = "Top-level calls took " + FormatDuration(profile.duration) +
+                " out of " + QString::number(profile.call_count) + " calls";
+      table->SetPlaceholder();
+    }
+    emit profileChanged();
+    DisplayProfile();
+  });
+}
+
+void CmakeProfileController::sortBy(int column) {
+  if (column < 0 || column >= kColumns.size()) {
+    return;
+  }
+  LOG() << "Sorting CMake profile by" << kColumns[column];
+  sort_column = column;
+  DisplayProfile();
+}
+
+void CmakeProfileController::DisplayProfile() {
+  QList<CmakeProfileEntry> entries = profile.entries;
+  // Names are sorted alphabetically, while numbers are sorted from the
+  // largest one, since the most expensive entries are the interesting ones.
+  std::stable_sort(
+      entries.begin(), entries.end(),
+      [this](const CmakeProfileEntry& a, const CmakeProfileEntry& b) {
+        switch (sort_column) {
+          case 0:
+            return a.name < b.name;
+          case 1:
+            return a.kind < b.kind;
+          case 3:
+            return a.self_duration > b.self_duration;
+          case 4:
+            return a.count > b.count;
+          default:
+            return a.duration > b.duration;
+        }
+      });
+  QList<QVariantList> rows;
+  for (const CmakeProfileEntry& entry : entries) {
+    rows.append({entry.name, CmakeProfileEntry::GetKindName(entry.kind),
+                 FormatDuration(entry.duration),
+                 FormatDuration(entry.self_duration), entry.count});
+  }
+  table->SetTable(kColumns, rows);
+}
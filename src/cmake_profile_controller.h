@@ -0,0 +1,34 @@
+#ifndef CMAKEPROFILECONTROLLER_H
+#define CMAKEPROFILECONTROLLER_H
+
+#include <QObject>
+#include <QtQmlIntegration>
+
+#include "cmake_profile.h"
+#include "sqlite_table_model.h"
+
+class CmakeProfileController : public QObject {
+  Q_OBJECT
+  QML_ELEMENT
+  Q_PROPERTY(SqliteTableModel* table MEMBER table CONSTANT)
+  Q_PROPERTY(QString summary MEMBER summary NOTIFY profileChanged)
+ public:
+  explicit CmakeProfileController(QObject* parent = nullptr);
+
+ public slots:
+  void load();
+  void sortBy(int column);
+
+ signals:
+  void profileChanged();
+
+ private:
+  void DisplayProfile();
+
+  SqliteTableModel* table;
+  CmakeProfile profile;
+  int sort_column;
+  QString summary;
+};
+
+#endif  // CMAKEPROFILECONTROLLER_H
@@ -0,0 +1,94 @@
+#include "cpu_profile.h"
+
+#include <QProcess>
+#include <QStringList>
+#include <algorithm>
+
+#define LOG() qDebug() << "[CpuProfile]"
+
+static void AddSample(CpuProfile& profile, const QString& comm,
+                      QStringList& frames) {
+  if (comm.isEmpty() && frames.isEmpty()) {
+    return;
+  }
+  // perf prints frames from the leaf to the root.
+  std::reverse(frames.begin(), frames.end());
+  frames.prepend(comm);
+  profile.folded_stacks[frames.join(';')]++;
+  profile.sample_count++;
+  frames.clear();
+}
+
+CpuProfile CpuProfile::CreateSync(const QString& perf_data_path) {
+  LOG() << "Folding stacks of" << perf_data_path;
+  CpuProfile profile;
+  QProcess proc;
+  proc.setStandardErrorFile(QProcess::nullDevice());
+  proc.start("perf", {"script", "-i", perf_data_path, "-F", "comm,ip,sym"});
+  if (!proc.waitForStarted()) {
+    LOG() << "Failed to run perf script:" << proc.errorString();
+    return profile;
+  }
+  // Each sample is a line with the name of the sampled process, followed by
+  // tab-indented lines of its frames ("<address> <symbol>") and an empty
+  // line.
+  QString comm;
+  QStringList frames;
+  auto parse_line = [&](const QByteArray& bytes) {
+    QString line = QString::fromUtf8(bytes).trimmed();
+    if (line.isEmpty()) {
+      AddSample(profile, comm, frames);
+      comm.clear();
+    } else if (bytes.startsWith('\t')) {
+      int i = line.indexOf(' ');
+      QString symbol = i < 0 ? QString() : line.sliced(i + 1);
+      // Frames can't contain the separator of frames.
+      symbol.replace(';', ':');
+      frames.append(symbol.isEmpty() ? "[unknown]" : symbol);
+    } else {
+      AddSample(profile, comm, frames);
+      comm = line;
+    }
+  };
+  while (proc.waitForReadyRead(-1) || proc.canReadLine()) {
+    while (proc.canReadLine()) {
+      parse_line(proc.readLine());
+    }
+  }
+  proc.waitForFinished(-1);
+  for (const QByteArray& line : proc.readAll().split('\n')) {
+    parse_line(line);
+  }
+  AddSample(profile, comm, frames);
+  if (proc.exitStatus() != QProcess::NormalExit || proc.exitCode() != 0) {
+    LOG() << "perf script has failed with code" << proc.exitCode();
+  }
+  LOG() << "Folded" << profile.sample_count << "samples into"
+        << profile.folded_stacks.size() << "stacks";
+  return profile;
+}
+
+CpuProfile CpuProfile::Deserialize(const QByteArray& bytes) {
+  CpuProfile profile;
+  QByteArray data = qUncompress(bytes);
+  for (const QByteArray& line : data.split('\n')) {
+    int i = line.lastIndexOf(' ');
+    if (i < 0) {
+      continue;
+    }
+    qint64 samples = line.sliced(i + 1).toLongLong();
+    profile.folded_stacks[QString::fromUtf8(line.sliced(0, i))] += samples;
+    profile.sample_count += samples;
+  }
+  return profile;
+}
+
+QByteArray CpuProfile::Serialize() const {
+  QByteArray data;
+  for (auto it = folded_stacks.begin(); it != folded_stacks.end(); it++) {
+    data += it.key().toUtf8() + ' ' + QByteArray::number(it.value()) + '\n';
+  }
+  return qCompress(data);
+}
+
+bool CpuProfile::IsNull() const { return sample_count == 0; }
@@ -0,0 +1,26 @@
+#ifndef CPUPROFILE_H
+#define CPUPROFILE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+/**
+ * Call stacks of a process, sampled by "perf record -g", folded the way
+ * flame graphs expect them: frames of each stack go from the root to the
+ * leaf, separated by ';', and identical stacks are merged, counting the
+ * samples, that they have been seen in.
+ */
+struct CpuProfile {
+  // Converts the samples with "perf script", which can take a while on large
+  // recordings.
+  static CpuProfile CreateSync(const QString& perf_data_path);
+  static CpuProfile Deserialize(const QByteArray& bytes);
+  QByteArray Serialize() const;
+  bool IsNull() const;
+
+  qint64 sample_count = 0;
+  QHash<QString, qint64> folded_stacks;
+};
+
+#endif  // CPUPROFILE_H
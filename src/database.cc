@@ -52,7 +52,69 @@ void Database::Initialize() {
       "exit_code INT, "
       "stderr_line_indices TEXT, "
       "output TEXT, "
+      "output_file TEXT, "
+      "output_line_index BLOB, "
+      "stderr_lines BLOB, "
+      "elided_size INT DEFAULT 0, "
+      "elided_line_count INT DEFAULT 0, "
+      "resource_usage BLOB, "
+      "line_times BLOB, "
+      "time_trace_report BLOB, "
+      "cmake_profile BLOB, "
+      "cpu_profile BLOB, "
+      "perf_counters BLOB, "
+      "allocation_profile BLOB, "
       "FOREIGN KEY(project_id) REFERENCES project(id) ON DELETE CASCADE)");
+  AddColumnIfNotExists("task_execution", "output_file", "TEXT");
+  AddColumnIfNotExists("task_execution", "output_line_index", "BLOB");
+  AddColumnIfNotExists("task_execution", "stderr_lines", "BLOB");
+  AddColumnIfNotExists("task_execution", "elided_size", "INT DEFAULT 0");
+  AddColumnIfNotExists("task_execution", "elided_line_count",
+                       "INT DEFAULT 0");
+  AddColumnIfNotExists("task_execution", "resource_usage", "BLOB");
+  AddColumnIfNotExists("task_execution", "line_times", "BLOB");
+  AddColumnIfNotExists("task_execution", "time_trace_report", "BLOB");
+  AddColumnIfNotExists("task_execution", "cmake_profile", "BLOB");
+  AddColumnIfNotExists("task_execution", "cpu_profile", "BLOB");
+  AddColumnIfNotExists("task_execution", "perf_counters", "BLOB");
+  AddColumnIfNotExists("task_execution", "allocation_profile", "BLOB");
+  ExecCmd(
+      "CREATE TABLE IF NOT EXISTS task_output_chunk("
+      "hash BLOB PRIMARY KEY, "
+      "data BLOB)");
+  ExecCmd(
+      "CREATE TABLE IF NOT EXISTS task_execution_output_chunk("
+      "execution_id BLOB, "
+      "chunk_index INT, "
+      "hash BLOB, "
+      "length INT, "
+      "PRIMARY KEY(execution_id, chunk_index), "
+      "FOREIGN KEY(execution_id) REFERENCES task_execution(id) "
+      "ON DELETE CASCADE)");
+  ExecCmd(
+      "CREATE INDEX IF NOT EXISTS task_execution_output_chunk_hash "
+      "ON task_execution_output_chunk(hash)");
+  ExecCmd(
+      "CREATE TABLE IF NOT EXISTS build_step("
+      "project_id BLOB, "
+      "build_folder TEXT, "
+      "output TEXT, "
+      "build_time DATETIME, "
+      "duration INT, "
+      "FOREIGN KEY(project_id) REFERENCES project(id) ON DELETE CASCADE)");
+  ExecCmd(
+      "CREATE INDEX IF NOT EXISTS build_step_output "
+      "ON build_step(project_id, build_folder, output, build_time)");
+  ExecCmd(
+      "CREATE TABLE IF NOT EXISTS cmake_configure("
+      "project_id BLOB, "
+      "build_path TEXT, "
+      "configure_time DATETIME, "
+      "duration INT, "
+      "FOREIGN KEY(project_id) REFERENCES project(id) ON DELETE CASCADE)");
+  ExecCmd(
+      "CREATE INDEX IF NOT EXISTS cmake_configure_build_path "
+      "ON cmake_configure(project_id, build_path, configure_time)");
   ExecCmd(
       "CREATE TABLE IF NOT EXISTS editor("
       "id INT PRIMARY KEY DEFAULT 1, "
@@ -74,7 +136,24 @@ void Database::Initialize() {
       "CREATE TABLE IF NOT EXISTS task_context("
       "id INT PRIMARY KEY DEFAULT 1,"
       "history_limit INT,"
-      "run_with_console_on_win BOOL DEFAULT FALSE)");
+      "run_with_console_on_win BOOL DEFAULT FALSE,"
+      "output_refresh_interval INT DEFAULT 16,"
+      "output_spill_threshold INT DEFAULT 64,"
+      "run_in_pty BOOL DEFAULT FALSE,"
+      "output_head_limit INT DEFAULT 32,"
+      "output_tail_limit INT DEFAULT 32,"
+      "job_limit INT DEFAULT 0,"
+      "slow_build_step_threshold INT DEFAULT 10)");
+  AddColumnIfNotExists("task_context", "output_refresh_interval",
+                       "INT DEFAULT 16");
+  AddColumnIfNotExists("task_context", "output_spill_threshold",
+                       "INT DEFAULT 64");
+  AddColumnIfNotExists("task_context", "run_in_pty", "BOOL DEFAULT FALSE");
+  AddColumnIfNotExists("task_context", "output_head_limit", "INT DEFAULT 32");
+  AddColumnIfNotExists("task_context", "output_tail_limit", "INT DEFAULT 32");
+  AddColumnIfNotExists("task_context", "job_limit", "INT DEFAULT 0");
+  AddColumnIfNotExists("task_context", "slow_build_step_threshold",
+                       "INT DEFAULT 10");
   ExecCmd("INSERT OR IGNORE INTO task_context(history_limit) VALUES(10)");
   ExecCmd(
       "CREATE TABLE IF NOT EXISTS documentation_folder("
@@ -149,6 +228,22 @@ void Database::Initialize() {
       "FOREIGN KEY(project_id) REFERENCES project(id) ON DELETE CASCADE)");
 }
 
+void Database::AddColumnIfNotExists(const QString &table,
+                                    const QString &column,
+                                    const QString &definition) {
+  // Databases created by older versions of the app have tables without
+  // columns that were introduced later.
+  QSqlQuery sql(QSqlDatabase::database());
+  ExecQuery(sql, "PRAGMA table_info(" + table + ")");
+  while (sql.next()) {
+    if (sql.value(1).toString() == column) {
+      return;
+    }
+  }
+  LOG() << "Adding column" << column << "to table" << table;
+  ExecCmd("ALTER TABLE " + table + " ADD COLUMN " + column + ' ' + definition);
+}
+
 void Database::ExecQuery(QSqlQuery &sql, const QString &query,
                          const QVariantList &args) {
   LOG() << "Executing query:" << query;
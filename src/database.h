@@ -24,6 +24,8 @@ class Database {
   };
 
   static void Initialize();
+  static void AddColumnIfNotExists(const QString& table, const QString& column,
+                                   const QString& definition);
 
   template <typename T>
   static QList<T> ExecQueryAndRead(const QString& query,
@@ -0,0 +1,233 @@
+#include "file_watcher.h"
+
+#include <QDir>
+#include <QFileInfo>
+
+#include "git_system.h"
+#include "io_task.h"
+
+#if __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <QSocketNotifier>
+#include <cerrno>
+#include <cstring>
+#else
+#include <QFileSystemWatcher>
+#endif
+
+#define LOG() qDebug() << "[FileWatcher]"
+
+static QString RemoveTrailingSlash(QString path) {
+  while (path.size() > 1 && path.endsWith('/')) {
+    path.chop(1);
+  }
+  return path;
+}
+
+FileWatcher::FileWatcher(QObject* parent) : QObject(parent) {
+  debounce_timer.setSingleShot(true);
+  debounce_timer.setInterval(500);
+  connect(&debounce_timer, &QTimer::timeout, this, &FileWatcher::filesChanged);
+}
+
+FileWatcher::~FileWatcher() { Stop(); }
+
+void FileWatcher::Watch(const QString& folder) {
+  Stop();
+  LOG() << "Watching" << folder;
+#if __linux__
+  fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd < 0) {
+    LOG() << "Failed to initialize inotify:" << strerror(errno);
+    return;
+  }
+  notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+  connect(notifier, &QSocketNotifier::activated, this,
+          &FileWatcher::ReadEvents);
+#else
+  watcher = new QFileSystemWatcher(this);
+  connect(watcher, &QFileSystemWatcher::directoryChanged, this,
+          &FileWatcher::OnChange);
+#endif
+  int id = watch_id;
+  IoTask::Run<Folders>(
+      this, [folder] { return FindFoldersSync({folder}); },
+      [this, id](Folders result) {
+        if (id != watch_id) {
+          return;
+        }
+        LOG() << "Found" << result.folders.size() << "folders to watch";
+        ignored_paths = result.ignored_paths;
+        for (const QString& folder : result.folders) {
+          AddFolder(folder);
+        }
+      });
+}
+
+void FileWatcher::Stop() {
+  watch_id++;
+  debounce_timer.stop();
+  ignored_paths.clear();
+#if __linux__
+  if (fd < 0) {
+    return;
+  }
+  LOG() << "Stopped watching";
+  delete notifier;
+  notifier = nullptr;
+  // Closing inotify instance removes all of its watches.
+  close(fd);
+  fd = -1;
+  folder_by_watch.clear();
+  new_folders.clear();
+  listing_new_folders = false;
+#else
+  if (!watcher) {
+    return;
+  }
+  LOG() << "Stopped watching";
+  delete watcher;
+  watcher = nullptr;
+#endif
+}
+
+bool FileWatcher::IsWatching() const {
+#if __linux__
+  return fd >= 0;
+#else
+  return watcher != nullptr;
+#endif
+}
+
+FileWatcher::Folders FileWatcher::FindFoldersSync(const QStringList& folders) {
+  Folders result;
+  for (const QString& path : GitSystem::FindIgnoredPathsSync()) {
+    result.ignored_paths.insert(RemoveTrailingSlash(path));
+  }
+  for (const QString& folder : folders) {
+    if (!result.ignored_paths.contains(RemoveTrailingSlash(folder))) {
+      result.folders.append(ListFolders(folder, result.ignored_paths));
+    }
+  }
+  return result;
+}
+
+QStringList FileWatcher::ListFolders(const QString& folder,
+                                     const QSet<QString>& ignored_paths) {
+  QStringList result;
+  // Ignored folders (e.g. build folders) can be huge, so they are not even
+  // visited. Hidden folders (e.g. .git) are skipped too.
+  QStringList to_visit = {RemoveTrailingSlash(folder)};
+  while (!to_visit.isEmpty()) {
+    QString current = to_visit.takeLast();
+    result.append(current);
+    QDir dir(current);
+    for (const QFileInfo& info :
+         dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+      QString path = info.absoluteFilePath();
+      if (!info.isSymLink() && !ignored_paths.contains(path)) {
+        to_visit.append(path);
+      }
+    }
+  }
+  return result;
+}
+
+bool FileWatcher::IsIgnored(const QString& path) const {
+  // Hidden files and backups are mostly temporary files of editors.
+  QString name = QFileInfo(path).fileName();
+  return name.startsWith('.') || name.endsWith('~') ||
+         ignored_paths.contains(path);
+}
+
+void FileWatcher::AddFolder(const QString& folder) {
+#if __linux__
+  if (fd < 0) {
+    return;
+  }
+  QByteArray path = folder.toLocal8Bit();
+  int wd = inotify_add_watch(fd, path.data(),
+                             IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+                                 IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR);
+  if (wd < 0) {
+    LOG() << "Failed to watch" << folder << ':' << strerror(errno);
+    return;
+  }
+  folder_by_watch[wd] = folder;
+#else
+  if (watcher) {
+    watcher->addPath(folder);
+  }
+#endif
+}
+
+void FileWatcher::OnChange(const QString& path) {
+  if (IsIgnored(path)) {
+    return;
+  }
+  // Restarting the timer postpones the notification until changes stop
+  // arriving.
+  debounce_timer.start();
+}
+
+#if __linux__
+void FileWatcher::ReadEvents() {
+  alignas(inotify_event) char buffer[16 * 1024];
+  while (fd >= 0) {
+    ssize_t count = read(fd, buffer, sizeof(buffer));
+    if (count <= 0) {
+      break;
+    }
+    for (char* p = buffer; p < buffer + count;) {
+      auto event = reinterpret_cast<const inotify_event*>(p);
+      p += sizeof(inotify_event) + event->len;
+      if (event->mask & IN_IGNORED) {
+        folder_by_watch.remove(event->wd);
+        continue;
+      }
+      if (!folder_by_watch.contains(event->wd) || event->len == 0) {
+        continue;
+      }
+      QString path = folder_by_watch[event->wd] + '/' +
+                     QString::fromLocal8Bit(event->name);
+      if (event->mask & IN_ISDIR) {
+        // New folders have to be watched too, while removed ones remove their
+        // watches by themselves.
+        if ((event->mask & (IN_CREATE | IN_MOVED_TO)) && !IsIgnored(path)) {
+          new_folders.append(path);
+        }
+        continue;
+      }
+      OnChange(path);
+    }
+  }
+  WatchNewFolders();
+}
+
+void FileWatcher::WatchNewFolders() {
+  // Builds create lots of folders at once, so only one listing runs at a
+  // time, and folders, created in the meantime, wait for it.
+  if (listing_new_folders || new_folders.isEmpty()) {
+    return;
+  }
+  listing_new_folders = true;
+  QStringList folders = new_folders;
+  new_folders.clear();
+  int id = watch_id;
+  IoTask::Run<Folders>(
+      this, [folders] { return FindFoldersSync(folders); },
+      [this, id](Folders result) {
+        if (id != watch_id) {
+          return;
+        }
+        listing_new_folders = false;
+        ignored_paths = result.ignored_paths;
+        for (const QString& folder : result.folders) {
+          AddFolder(folder);
+        }
+        WatchNewFolders();
+      });
+}
+#endif
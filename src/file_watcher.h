@@ -0,0 +1,72 @@
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#if __linux__
+class QSocketNotifier;
+#else
+class QFileSystemWatcher;
+#endif
+
+/**
+ * Watches all the folders of a project, except the ones ignored by git, and
+ * notifies about changes of files in them. Editors save a file in several
+ * steps and builds change many files at once, so changes are reported only
+ * once they stop arriving for a while. On Linux folders are watched with
+ * inotify, which also notices new sub-folders: they are listed on the IO
+ * thread, together with paths ignored by git, which might include them now
+ * (e.g. a new build folder). Elsewhere only changes of folders' contents are
+ * noticed, which is enough for editors, that save files by replacing them.
+ */
+class FileWatcher : public QObject {
+  Q_OBJECT
+ public:
+  explicit FileWatcher(QObject* parent = nullptr);
+  ~FileWatcher();
+  void Watch(const QString& folder);
+  void Stop();
+  bool IsWatching() const;
+
+ signals:
+  void filesChanged();
+
+ private:
+  struct Folders {
+    QStringList folders;
+    QSet<QString> ignored_paths;
+  };
+
+  static Folders FindFoldersSync(const QStringList& folders);
+  static QStringList ListFolders(const QString& folder,
+                                 const QSet<QString>& ignored_paths);
+  bool IsIgnored(const QString& path) const;
+  void AddFolder(const QString& folder);
+  void OnChange(const QString& path);
+#if __linux__
+  void ReadEvents();
+  void WatchNewFolders();
+
+  int fd = -1;
+  QSocketNotifier* notifier = nullptr;
+  QHash<int, QString> folder_by_watch;
+  // Folders, that have been created while the previously created ones were
+  // being listed.
+  QStringList new_folders;
+  bool listing_new_folders = false;
+#else
+  QFileSystemWatcher* watcher = nullptr;
+#endif
+  QSet<QString> ignored_paths;
+  QTimer debounce_timer;
+  // Incremented each time watching starts or stops, so that folders, found
+  // for a watch, that has already been stopped, get discarded.
+  int watch_id = 0;
+};
+
+#endif  // FILEWATCHER_H
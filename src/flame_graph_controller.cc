@@ -0,0 +1,183 @@
+#include "flame_graph_controller.h"
+
+#include <QColor>
+#include <algorithm>
+
+#include "application.h"
+
+#define LOG() qDebug() << "[FlameGraphController]"
+
+// Frames, that are narrower than this fraction of the zoomed frame, are not
+// displayed, since they would not be visible anyway.
+static constexpr double kMinFrameWidth = 0.001;
+
+FlameGraphController::FlameGraphController(QObject* parent)
+    : QObject(parent) {
+  Application& app = Application::Get();
+  app.view.SetWindowTitle("Flame Graph");
+  // Profile of a running execution becomes available once it finishes.
+  connect(&app.task, &TaskSystem::executionFinished, this, [this](QUuid id) {
+    if (id == execution_id) {
+      load();
+    }
+  });
+  load();
+}
+
+bool FlameGraphController::IsZoomed() const { return zoomed_frame > 0; }
+
+void FlameGraphController::load() {
+  Application& app = Application::Get();
+  execution_id = app.task.GetSelectedExecutionId();
+  LOG() << "Loading CPU profile of execution" << execution_id;
+  if (const TaskExecution* exec = app.task.FindExecutionById(execution_id)) {
+    placeholder_text = "Profiling " + exec->task_name + "...";
+    emit framesChanged();
+    return;
+  }
+  placeholder_text = "Loading CPU profile...";
+  emit framesChanged();
+  app.task.FetchCpuProfile(execution_id)
+      .Then(this, [this](const CpuProfile& profile) {
+        graph.clear();
+        graph.append(FlameGraphFrame{"all"});
+        for (auto it = profile.folded_stacks.begin();
+             it != profile.folded_stacks.end(); it++) {
+          int frame = 0;
+          graph[frame].samples += it.value();
+          for (const QString& name : it.key().split(';')) {
+            int child = graph[frame].children.value(name, -1);
+            if (child < 0) {
+              child = graph.size();
+              graph[frame].children[name] = child;
+              FlameGraphFrame f;
+              f.name = name;
+              f.parent = frame;
+              f.depth = graph[frame].depth + 1;
+              graph.append(f);
+            }
+            graph[child].samples += it.value();
+            frame = child;
+          }
+        }
+        LOG() << "Loaded" << profile.sample_count << "samples";
+        zoomed_frame = 0;
+        if (profile.IsNull()) {
+          placeholder_text =
+              "Execution has not been profiled. Run an executable with "
+              "profiling to see where it spends its time.";
+        } else {
+          placeholder_text.clear();
+        }
+        selectFrame(0);
+        DisplayFrames();
+      });
+}
+
+void FlameGraphController::zoomIn(int frame) {
+  if (frame < 0 || frame >= graph.size()) {
+    return;
+  }
+  zoomed_frame = frame;
+  DisplayFrames();
+}
+
+void FlameGraphController::zoomOut() {
+  if (zoomed_frame > 0) {
+    zoomIn(graph[zoomed_frame].parent);
+  }
+}
+
+void FlameGraphController::resetZoom() { zoomIn(0); }
+
+void FlameGraphController::selectFrame(int frame) {
+  if (frame < 0 || frame >= graph.size()) {
+    return;
+  }
+  const FlameGraphFrame& f = graph[frame];
+  details = f.name + ": " + FormatSamples(f.samples);
+  if (!filter.isEmpty()) {
+    details += "  Matched: " + FormatSamples(CountMatchedSamples(0));
+  }
+  emit detailsChanged();
+}
+
+void FlameGraphController::setFilter(const QString& value) {
+  filter = value;
+  selectFrame(zoomed_frame);
+  DisplayFrames();
+}
+
+void FlameGraphController::DisplayFrames() {
+  visible_frames.clear();
+  max_depth = 0;
+  if (!graph.isEmpty() && graph[0].samples > 0) {
+    // Ancestors of the zoomed frame span the whole width.
+    for (int f = graph[zoomed_frame].parent; f >= 0; f = graph[f].parent) {
+      AddVisibleFrames(f, -1);
+    }
+    AddVisibleFrames(zoomed_frame, 0);
+  }
+  emit framesChanged();
+}
+
+void FlameGraphController::AddVisibleFrames(int frame, double x) {
+  const FlameGraphFrame& f = graph[frame];
+  double width = 1;
+  if (x >= 0) {
+    width = static_cast<double>(f.samples) / graph[zoomed_frame].samples;
+    if (width < kMinFrameWidth) {
+      return;
+    }
+  }
+  // Warm colors, that stay the same for the same function.
+  QColor color = QColor::fromHsl(qHash(f.name) % 50, 200, 140);
+  visible_frames.append(QVariantMap{
+      {"index", frame},
+      {"name", f.name},
+      {"x", std::max(x, 0.0)},
+      {"width", width},
+      {"depth", f.depth},
+      {"color", color.name()},
+      {"highlighted", MatchesFilter(frame)},
+  });
+  max_depth = std::max(max_depth, f.depth + 1);
+  if (x < 0) {
+    return;
+  }
+  // Children are ordered by name, like in classic flame graphs, so that
+  // graphs of different runs can be compared with each other.
+  QStringList names = f.children.keys();
+  std::sort(names.begin(), names.end());
+  for (const QString& name : names) {
+    int child = f.children[name];
+    AddVisibleFrames(child, x);
+    x += static_cast<double>(graph[child].samples) /
+         graph[zoomed_frame].samples;
+  }
+}
+
+QString FlameGraphController::FormatSamples(qint64 samples) const {
+  double total = graph.isEmpty() ? 0 : graph[0].samples;
+  double percent = total > 0 ? 100 * samples / total : 0;
+  return QString::number(samples) + " samples (" +
+         QString::number(percent, 'f', 2) + "%)";
+}
+
+bool FlameGraphController::MatchesFilter(int frame) const {
+  return !filter.isEmpty() &&
+         graph[frame].name.contains(filter, Qt::CaseInsensitive);
+}
+
+qint64 FlameGraphController::CountMatchedSamples(int frame) const {
+  // Samples of matched frames, that are nested into other matched frames,
+  // are already counted.
+  if (MatchesFilter(frame)) {
+    return graph[frame].samples;
+  }
+  qint64 samples = 0;
+  for (int child : graph[frame].children) {
+    samples += CountMatchedSamples(child);
+  }
+  return samples;
+}
@@ -0,0 +1,62 @@
+#ifndef FLAMEGRAPHCONTROLLER_H
+#define FLAMEGRAPHCONTROLLER_H
+
+#include <QHash>
+#include <QObject>
+#include <QUuid>
+#include <QVariantList>
+#include <QtQmlIntegration>
+
+#include "cpu_profile.h"
+
+struct FlameGraphFrame {
+  QString name;
+  qint64 samples = 0;
+  int parent = -1;
+  int depth = 0;
+  QHash<QString, int> children;
+};
+
+class FlameGraphController : public QObject {
+  Q_OBJECT
+  QML_ELEMENT
+  Q_PROPERTY(QVariantList frames MEMBER visible_frames NOTIFY framesChanged)
+  Q_PROPERTY(int depth MEMBER max_depth NOTIFY framesChanged)
+  Q_PROPERTY(bool isZoomed READ IsZoomed NOTIFY framesChanged)
+  Q_PROPERTY(QString details MEMBER details NOTIFY detailsChanged)
+  Q_PROPERTY(
+      QString placeholderText MEMBER placeholder_text NOTIFY framesChanged)
+ public:
+  explicit FlameGraphController(QObject* parent = nullptr);
+  bool IsZoomed() const;
+
+ public slots:
+  void load();
+  void zoomIn(int frame);
+  void zoomOut();
+  void resetZoom();
+  void selectFrame(int frame);
+  void setFilter(const QString& value);
+
+ signals:
+  void framesChanged();
+  void detailsChanged();
+
+ private:
+  void DisplayFrames();
+  void AddVisibleFrames(int frame, double x);
+  QString FormatSamples(qint64 samples) const;
+  bool MatchesFilter(int frame) const;
+  qint64 CountMatchedSamples(int frame) const;
+
+  QUuid execution_id;
+  QList<FlameGraphFrame> graph;
+  int zoomed_frame = 0;
+  QString filter;
+  QVariantList visible_frames;
+  int max_depth = 0;
+  QString details;
+  QString placeholder_text;
+};
+
+#endif  // FLAMEGRAPHCONTROLLER_H
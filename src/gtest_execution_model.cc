@@ -7,19 +7,22 @@
 #define LOG() qDebug() << "[GTestExecutionModel]"
 
 GTestExecutionModel::GTestExecutionModel(QObject* parent)
-    : TestExecutionModel(parent), current_output_line(0), test_count(-1) {
+    : TestExecutionModel(parent),
+      output_size(0),
+      shards(1),
+      is_sharded(false) {
   Application& app = Application::Get();
   app.view.SetWindowTitle("Google Test Execution");
-  connect(&app.task, &TaskSystem::executionOutputChanged, this,
-          [this, &app](QUuid id) {
+  connect(&app.task, &TaskSystem::executionOutputAppended, this,
+          [this, &app](QUuid id, int offset, const QString& data) {
             if (app.task.GetSelectedExecutionId() == id) {
-              ReloadExecution();
+              AppendOutput(offset, data);
             }
           });
   connect(&app.task, &TaskSystem::executionFinished, this,
           [this, &app](QUuid id) {
             if (app.task.GetSelectedExecutionId() == id) {
-              SetTestCount(-1);
+              FinishExecution();
             }
           });
   connect(this, &TestExecutionModel::rerunTest, this,
@@ -34,67 +37,146 @@ void GTestExecutionModel::ReloadExecution() {
   QUuid id = app.task.GetSelectedExecutionId();
   app.task.FetchExecution(id, true).Then(
       this, [this](const TaskExecution& exec) {
-        static const QRegularExpression kGlobalStartRegex(
-            "\\[\\=+\\] Running ([0-9]+)");
-        static const QRegularExpression kTestStartRegex(
-            "\\[\\s+RUN\\s+\\] (.+)\\.(.+)");
-        static const QRegularExpression kTestOkRegex(
-            "\\[\\s+OK\\s+\\] (.+)\\.(.+)");
-        static const QRegularExpression kTestFailedRegex(
-            "\\[\\s+FAILED\\s+\\] (.+)\\.(.+)");
         this->exec = exec;
         emit taskNameChanged();
-        QStringList lines = exec.output.split('\n', Qt::SkipEmptyParts);
-        if (lines.size() < current_output_line) {
-          current_output_line = 0;
-          test_count = -1;
-          current_test_case.clear();
-          Clear();
-        }
-        for (; current_output_line < lines.size(); current_output_line++) {
-          const QString& line = lines[current_output_line];
-          LOG() << "New raw line:" << line;
-          if (test_count < 0) {
-            QRegularExpressionMatch m = kGlobalStartRegex.match(line);
-            if (m.hasMatch()) {
-              test_count = m.captured(1).toInt();
-              SetTestCount(test_count);
-            } else {
-              AppendTestPreparationOutput(line + '\n');
-            }
-            continue;
-          }
-          if (current_test_case.isEmpty()) {
-            QRegularExpressionMatch m = kTestStartRegex.match(line);
-            if (m.hasMatch()) {
-              QString test_suite = m.captured(1);
-              current_test_case = m.captured(2);
-              StartTest(test_suite, current_test_case,
-                        test_suite + '.' + current_test_case);
-            }
-            continue;
-          }
-          QRegularExpressionMatch m = kTestOkRegex.match(line);
-          if (m.hasMatch()) {
-            FinishCurrentTest(true);
-            current_test_case.clear();
-            continue;
-          }
-          m = kTestFailedRegex.match(line);
-          if (m.hasMatch()) {
-            FinishCurrentTest(false);
-            current_test_case.clear();
-            continue;
-          }
-          AppendOutputToCurrentTest(line + '\n');
-        }
-        Load(GetRowCount() - 1);
+        output_size = exec.output.GetSize();
+        last_line.clear();
+        shards = QList<GTestShard>(1);
+        is_sharded = false;
+        Clear();
+        ParseOutput(exec.output.GetText());
         if (exec.exit_code) {
-          SetTestCount(-1);
+          FinishExecution();
         }
       });
 }
 
+void GTestExecutionModel::AppendOutput(int offset, const QString& data) {
+  int last_line_offset = output_size - last_line.size();
+  if (offset < last_line_offset || offset > output_size) {
+    // The output has been reset (e.g. the task is being re-run until it
+    // fails) so we need to start parsing it from scratch.
+    ReloadExecution();
+    return;
+  }
+  // Only the last line, that has not been parsed yet, can get overwritten.
+  last_line.truncate(offset - last_line_offset);
+  output_size = offset + data.size();
+  ParseOutput(data);
+}
+
+void GTestExecutionModel::ParseOutput(const QString& data) {
+  // Output arrives in arbitrary pieces, so the last line of it might not be
+  // complete yet: keep it until the rest of it arrives.
+  QString text = last_line + data;
+  int pos = 0;
+  while (true) {
+    int i = text.indexOf('\n', pos);
+    if (i < 0) {
+      break;
+    }
+    if (i > pos) {
+      ParseLine(text.sliced(pos, i - pos));
+    }
+    pos = i + 1;
+  }
+  last_line = text.sliced(pos);
+  Load(GetRowCount() - 1);
+}
+
+void GTestExecutionModel::ParseLine(const QString& line) {
+  static const QRegularExpression kShardedRunRegex("^\\[shards ([0-9]+)\\] ");
+  static const QRegularExpression kShardRegex(
+      "^\\[shard ([0-9]+)/[0-9]+\\] ");
+  LOG() << "New raw line:" << line;
+  QRegularExpressionMatch m = kShardedRunRegex.match(line);
+  if (m.hasMatch()) {
+    is_sharded = true;
+    shards = QList<GTestShard>(std::max(m.captured(1).toInt(), 1));
+    AppendTestPreparationOutput(line + '\n');
+    return;
+  }
+  if (!is_sharded) {
+    ParseShardLine(shards[0], line);
+    return;
+  }
+  m = kShardRegex.match(line);
+  if (!m.hasMatch()) {
+    AppendTestPreparationOutput(line + '\n');
+    return;
+  }
+  int i = m.captured(1).toInt();
+  if (i < shards.size()) {
+    ParseShardLine(shards[i], line.sliced(m.capturedLength()));
+  }
+}
+
+void GTestExecutionModel::ParseShardLine(GTestShard& shard,
+                                         const QString& line) {
+  static const QRegularExpression kGlobalStartRegex(
+      "\\[\\=+\\] Running ([0-9]+)");
+  static const QRegularExpression kTestStartRegex(
+      "\\[\\s+RUN\\s+\\] (.+)\\.(.+)");
+  static const QRegularExpression kTestOkRegex("\\[\\s+OK\\s+\\] (.+)\\.(.+)");
+  static const QRegularExpression kTestFailedRegex(
+      "\\[\\s+FAILED\\s+\\] (.+)\\.(.+)");
+  if (shard.test_count < 0) {
+    QRegularExpressionMatch m = kGlobalStartRegex.match(line);
+    if (m.hasMatch()) {
+      shard.test_count = m.captured(1).toInt();
+      UpdateTestCount();
+    } else {
+      AppendTestPreparationOutput(line + '\n');
+    }
+    return;
+  }
+  if (shard.current_test_case.isEmpty()) {
+    QRegularExpressionMatch m = kTestStartRegex.match(line);
+    if (m.hasMatch()) {
+      QString test_suite = m.captured(1);
+      shard.current_test_case = m.captured(2);
+      shard.current_test =
+          StartTest(test_suite, shard.current_test_case,
+                    test_suite + '.' + shard.current_test_case);
+    }
+    return;
+  }
+  QRegularExpressionMatch m = kTestOkRegex.match(line);
+  if (m.hasMatch()) {
+    FinishTest(shard.current_test, true);
+    shard.current_test_case.clear();
+    return;
+  }
+  m = kTestFailedRegex.match(line);
+  if (m.hasMatch()) {
+    FinishTest(shard.current_test, false);
+    shard.current_test_case.clear();
+    return;
+  }
+  AppendOutputToTest(shard.current_test, line + '\n');
+}
+
+void GTestExecutionModel::UpdateTestCount() {
+  // Total test count is only known once each shard has reported its own.
+  int count = 0;
+  for (const GTestShard& shard : shards) {
+    if (shard.test_count < 0) {
+      return;
+    }
+    count += shard.test_count;
+  }
+  SetTestCount(count);
+}
+
+void GTestExecutionModel::FinishExecution() {
+  if (!last_line.isEmpty()) {
+    ParseLine(last_line);
+    last_line.clear();
+    Load(GetRowCount() - 1);
+  }
+  SetTestCount(-1);
+}
+
 void GTestExecutionModel::ReRunTestCase(const QString id,
                                         bool repeat_until_fail) {
   Application::Get().task.RunTaskOfExecution(
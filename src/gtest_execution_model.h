@@ -6,6 +6,14 @@
 #include "task_system.h"
 #include "test_execution_model.h"
 
+// State of parsing of output of a single test executable. An execution, that
+// has been split into shards, has one per shard.
+struct GTestShard {
+  int test_count = -1;
+  QString current_test_case;
+  int current_test = -1;
+};
+
 class GTestExecutionModel : public TestExecutionModel {
   Q_OBJECT
   QML_ELEMENT
@@ -19,12 +27,19 @@ class GTestExecutionModel : public TestExecutionModel {
 
  private:
   void ReloadExecution();
+  void AppendOutput(int offset, const QString& data);
+  void ParseOutput(const QString& data);
+  void ParseLine(const QString& line);
+  void ParseShardLine(GTestShard& shard, const QString& line);
+  void UpdateTestCount();
+  void FinishExecution();
   void ReRunTestCase(const QString id, bool repeat_until_fail);
 
   TaskExecution exec;
-  int current_output_line;
-  int test_count;
-  QString current_test_case;
+  int output_size;
+  QString last_line;
+  QList<GTestShard> shards;
+  bool is_sharded;
 };
 
 #endif  // GTESTEXECUTIONMODEL_H
@@ -0,0 +1,77 @@
+#include "interval_set.h"
+
+#include <algorithm>
+
+#include "varint.h"
+
+IntervalSet IntervalSet::Deserialize(const QByteArray& bytes) {
+  IntervalSet set;
+  int pos = 0;
+  int last = -1;
+  while (pos < bytes.size()) {
+    quint32 gap, length;
+    if (!VarInt::Read(bytes, pos, gap) || !VarInt::Read(bytes, pos, length)) {
+      break;
+    }
+    int first = last + 1 + gap;
+    last = first + length;
+    set.intervals.append(std::make_pair(first, last));
+  }
+  return set;
+}
+
+QByteArray IntervalSet::Serialize() const {
+  // Each interval is encoded as its distance from the previous one followed
+  // by its length, both as variable-length integers, which most of the time
+  // fit in a byte or two.
+  QByteArray bytes;
+  int last = -1;
+  for (auto [start, end] : intervals) {
+    VarInt::Write(bytes, start - last - 1);
+    VarInt::Write(bytes, end - start);
+    last = end;
+  }
+  return bytes;
+}
+
+void IntervalSet::Insert(int value) { Insert(value, value); }
+
+void IntervalSet::Insert(int first, int last) {
+  if (first > last) {
+    return;
+  }
+  // Most of the time values are inserted in ascending order.
+  if (intervals.isEmpty() || intervals.constLast().second + 1 < first) {
+    intervals.append(std::make_pair(first, last));
+    return;
+  }
+  // Find all intervals, that overlap or touch the inserted one, and merge
+  // them together with it.
+  auto begin = std::lower_bound(
+      intervals.begin(), intervals.end(), first,
+      [](const std::pair<int, int>& i, int v) { return i.second + 1 < v; });
+  auto end = begin;
+  while (end != intervals.end() && end->first <= last + 1) {
+    first = std::min(first, end->first);
+    last = std::max(last, end->second);
+    end++;
+  }
+  int i = begin - intervals.begin();
+  intervals.erase(begin, end);
+  intervals.insert(i, std::make_pair(first, last));
+}
+
+bool IntervalSet::Contains(int value) const {
+  auto it = std::upper_bound(
+      intervals.cbegin(), intervals.cend(), value,
+      [](int v, const std::pair<int, int>& i) { return v < i.first; });
+  return it != intervals.cbegin() && std::prev(it)->second >= value;
+}
+
+void IntervalSet::Clear() { intervals.clear(); }
+
+bool IntervalSet::IsEmpty() const { return intervals.isEmpty(); }
+
+const QList<std::pair<int, int>>& IntervalSet::GetIntervals() const {
+  return intervals;
+}
@@ -0,0 +1,28 @@
+#ifndef INTERVALSET_H
+#define INTERVALSET_H
+
+#include <QByteArray>
+#include <QList>
+
+/**
+ * Set of integers, stored as a sorted list of inclusive intervals. Meant for
+ * sets, that mostly consist of long runs of consecutive numbers (e.g. indices
+ * of lines, printed to stderr), where it takes space proportional to the
+ * number of runs instead of the number of elements.
+ */
+class IntervalSet {
+ public:
+  static IntervalSet Deserialize(const QByteArray& bytes);
+  QByteArray Serialize() const;
+  void Insert(int value);
+  void Insert(int first, int last);
+  bool Contains(int value) const;
+  void Clear();
+  bool IsEmpty() const;
+  const QList<std::pair<int, int>>& GetIntervals() const;
+
+ private:
+  QList<std::pair<int, int>> intervals;
+};
+
+#endif  // INTERVALSET_H
@@ -0,0 +1,95 @@
+#include "line_times.h"
+
+#include <algorithm>
+
+#include "varint.h"
+
+LineTimes LineTimes::Deserialize(const QByteArray& bytes) {
+  LineTimes result;
+  int pos = 0;
+  quint32 time = 0;
+  while (pos < bytes.size()) {
+    quint32 delta;
+    if (!VarInt::Read(bytes, pos, delta)) {
+      break;
+    }
+    time += delta;
+    result.times.append(time);
+  }
+  return result;
+}
+
+QByteArray LineTimes::Serialize() const {
+  QByteArray bytes;
+  quint32 last = 0;
+  for (quint32 time : times) {
+    VarInt::Write(bytes, time - last);
+    last = time;
+  }
+  return bytes;
+}
+
+void LineTimes::Set(int line, quint32 time) {
+  if (line < 0) {
+    return;
+  }
+  while (times.size() <= line) {
+    times.append(time);
+  }
+  times[line] = time;
+}
+
+void LineTimes::Truncate(int line_count) {
+  if (line_count < times.size()) {
+    times.resize(std::max(line_count, 0));
+  }
+}
+
+void LineTimes::Collapse(int first, int last) {
+  last = std::min(last, static_cast<int>(times.size()));
+  if (first < 0 || first >= last) {
+    return;
+  }
+  times[first] = times[last - 1];
+  times.remove(first + 1, last - first - 1);
+}
+
+void LineTimes::Clear() { times.clear(); }
+
+LineTimes LineTimes::Mid(int first) const {
+  LineTimes result;
+  result.times = times.mid(std::max(first, 0));
+  return result;
+}
+
+void LineTimes::Replace(int first, const LineTimes& other) {
+  Truncate(first);
+  for (int i = 0; i < other.times.size(); i++) {
+    Set(first + i, other.times[i]);
+  }
+}
+
+int LineTimes::GetCount() const { return times.size(); }
+
+quint32 LineTimes::GetTime(int line) const {
+  return line >= 0 && line < times.size() ? times[line] : 0;
+}
+
+qint64 LineTimes::GetGap(int line) const {
+  if (line <= 0 || line >= times.size()) {
+    return 0;
+  }
+  return static_cast<qint64>(times[line]) - times[line - 1];
+}
+
+int LineTimes::FindLargestGap() const {
+  int result = -1;
+  qint64 largest_gap = 0;
+  for (int i = 1; i < times.size(); i++) {
+    if (qint64 gap = GetGap(i); gap > largest_gap) {
+      largest_gap = gap;
+      result = i;
+    }
+  }
+  return result;
+}
@@ -0,0 +1,42 @@
+#ifndef LINETIMES_H
+#define LINETIMES_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMetaType>
+
+/**
+ * Times, at which lines of a text have arrived, in milliseconds since some
+ * monotonic starting point. A line arrives once it ends, so a gap between two
+ * consecutive lines is how long it took to get the second one. Times never
+ * decrease, so they get serialized as deltas between consecutive lines, which
+ * mostly fit in a single byte.
+ */
+class LineTimes {
+ public:
+  static LineTimes Deserialize(const QByteArray& bytes);
+  QByteArray Serialize() const;
+  // Line should either exist or go right after the last one.
+  void Set(int line, quint32 time);
+  void Truncate(int line_count);
+  // Replace lines in [first, last) range with a single line, that arrived
+  // when the last of them did.
+  void Collapse(int first, int last);
+  void Clear();
+  // Times of lines starting from the first one.
+  LineTimes Mid(int first) const;
+  // Replace times of lines starting from the first one with the specified
+  // ones.
+  void Replace(int first, const LineTimes& other);
+  int GetCount() const;
+  quint32 GetTime(int line) const;
+  qint64 GetGap(int line) const;
+  int FindLargestGap() const;
+
+ private:
+  QList<quint32> times;
+};
+
+Q_DECLARE_METATYPE(LineTimes)
+
+#endif  // LINETIMES_H
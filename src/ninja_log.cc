@@ -0,0 +1,56 @@
+#include "ninja_log.h"
+
+#include <QFile>
+#include <QFileInfo>
+
+qint64 NinjaLogEntry::GetDuration() const { return end - start; }
+
+QString NinjaLog::GetPath(const QString& build_folder) {
+  QString path = build_folder;
+  if (!path.isEmpty() && !path.endsWith('/')) {
+    path += '/';
+  }
+  return path + ".ninja_log";
+}
+
+qint64 NinjaLog::GetSizeSync(const QString& path) {
+  QFileInfo info(path);
+  return info.exists() ? info.size() : 0;
+}
+
+QList<NinjaLogEntry> NinjaLog::ReadSync(const QString& path,
+                                        qint64& offset) {
+  QList<NinjaLogEntry> entries;
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return entries;
+  }
+  if (file.size() < offset) {
+    // Ninja re-writes the log without redundant entries, when it gets too
+    // large, before starting a build. Entries, that have been written since
+    // then, can't be told apart from the older ones.
+    offset = file.size();
+    return entries;
+  }
+  file.seek(offset);
+  QByteArray data = file.readAll();
+  // The last line might still be being written.
+  int end = data.lastIndexOf('\n') + 1;
+  offset += end;
+  for (const QByteArray& line : data.left(end).split('\n')) {
+    if (line.isEmpty() || line.startsWith('#')) {
+      continue;
+    }
+    // <start>\t<end>\t<mtime>\t<output>\t<command hash>
+    QList<QByteArray> fields = line.split('\t');
+    if (fields.size() < 4) {
+      continue;
+    }
+    NinjaLogEntry entry;
+    entry.start = fields[0].toLongLong();
+    entry.end = fields[1].toLongLong();
+    entry.output = QString::fromUtf8(fields[3]);
+    entries.append(entry);
+  }
+  return entries;
+}
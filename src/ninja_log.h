@@ -0,0 +1,29 @@
+#ifndef NINJALOG_H
+#define NINJALOG_H
+
+#include <QList>
+#include <QString>
+
+struct NinjaLogEntry {
+  // Times are in milliseconds since the start of the build.
+  qint64 start = 0;
+  qint64 end = 0;
+  QString output;
+
+  qint64 GetDuration() const;
+};
+
+/**
+ * .ninja_log of a build folder, to which Ninja appends an entry each time it
+ * finishes a step of a build. Entries are read starting from an offset, so
+ * that only steps of a specific build get read.
+ */
+class NinjaLog {
+ public:
+  static QString GetPath(const QString& build_folder);
+  static qint64 GetSizeSync(const QString& path);
+  // Reads complete entries after the offset and moves the offset past them.
+  static QList<NinjaLogEntry> ReadSync(const QString& path, qint64& offset);
+};
+
+#endif  // NINJALOG_H
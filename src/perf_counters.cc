@@ -0,0 +1,166 @@
+#include "perf_counters.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocale>
+#include <algorithm>
+#include <cmath>
+
+#define LOG() qDebug() << "[PerfCounters]"
+
+// Relative change of IPC or cache misses, that is considered a regression.
+static constexpr double kRegressionThreshold = 0.05;
+
+QString PerfCounters::GetEvents() {
+  return "cycles,instructions,cache-misses,branch-misses,task-clock";
+}
+
+static void AddCounter(qint64& counter, qint64 value) {
+  counter = std::max(counter, 0LL) + value;
+}
+
+PerfCounters PerfCounters::ParseSync(const QString& path) {
+  PerfCounters counters;
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    LOG() << "Failed to open" << path;
+    return counters;
+  }
+  // Each line looks like "<value>,<unit>,<event>,<run time>,...".
+  for (const QByteArray& line : file.readAll().split('\n')) {
+    if (line.isEmpty() || line.startsWith('#')) {
+      continue;
+    }
+    QList<QByteArray> fields = line.split(',');
+    if (fields.size() < 3) {
+      continue;
+    }
+    bool ok = false;
+    double value = fields[0].toDouble(&ok);
+    // Value is "<not counted>" or "<not supported>" otherwise.
+    if (!ok) {
+      continue;
+    }
+    // Hybrid CPUs report each event for each type of their cores
+    // (e.g. "cpu_core/cycles/"), while modifiers (e.g. "cycles:u") get
+    // appended to events, that are not counted in the kernel.
+    QByteArray event = fields[2];
+    if (int i = event.indexOf('/'); i >= 0) {
+      event = event.sliced(i + 1);
+    }
+    if (int i = event.indexOf('/'); i >= 0) {
+      event.truncate(i);
+    }
+    if (int i = event.indexOf(':'); i >= 0) {
+      event.truncate(i);
+    }
+    qint64 count = static_cast<qint64>(value);
+    if (event == "cycles") {
+      AddCounter(counters.cycles, count);
+    } else if (event == "instructions") {
+      AddCounter(counters.instructions, count);
+    } else if (event == "cache-misses") {
+      AddCounter(counters.cache_misses, count);
+    } else if (event == "branch-misses") {
+      AddCounter(counters.branch_misses, count);
+    } else if (event == "task-clock") {
+      counters.task_clock = std::max(counters.task_clock, 0.0) + value;
+    }
+  }
+  return counters;
+}
+
+PerfCounters PerfCounters::Deserialize(const QByteArray& bytes) {
+  PerfCounters counters;
+  QJsonObject o = QJsonDocument::fromJson(bytes).object();
+  counters.cycles = o["cycles"].toInteger(-1);
+  counters.instructions = o["instructions"].toInteger(-1);
+  counters.cache_misses = o["cache_misses"].toInteger(-1);
+  counters.branch_misses = o["branch_misses"].toInteger(-1);
+  counters.task_clock = o["task_clock"].toDouble(-1);
+  return counters;
+}
+
+QByteArray PerfCounters::Serialize() const {
+  QJsonObject o;
+  o["cycles"] = cycles;
+  o["instructions"] = instructions;
+  o["cache_misses"] = cache_misses;
+  o["branch_misses"] = branch_misses;
+  o["task_clock"] = task_clock;
+  return QJsonDocument(o).toJson(QJsonDocument::Compact);
+}
+
+bool PerfCounters::IsNull() const {
+  return cycles < 0 && instructions < 0 && cache_misses < 0 &&
+         branch_misses < 0 && task_clock < 0;
+}
+
+double PerfCounters::GetIpc() const {
+  return cycles > 0 && instructions >= 0
+             ? static_cast<double>(instructions) / cycles
+             : -1;
+}
+
+double PerfCounters::GetCacheMpki() const {
+  return instructions > 0 && cache_misses >= 0
+             ? 1000.0 * cache_misses / instructions
+             : -1;
+}
+
+static QString FormatCounter(qint64 value) {
+  return value < 0 ? "not supported" : QLocale::system().toString(value);
+}
+
+QString PerfCounters::FormatReport() const {
+  QString result = "\nHardware counters:\n";
+  result += "  Cycles: " + FormatCounter(cycles) + '\n';
+  result += "  Instructions: " + FormatCounter(instructions);
+  if (double ipc = GetIpc(); ipc >= 0) {
+    result += " (" + QString::number(ipc, 'f', 2) + " per cycle)";
+  }
+  result += "\n  Cache misses: " + FormatCounter(cache_misses);
+  if (double mpki = GetCacheMpki(); mpki >= 0) {
+    result += " (" + QString::number(mpki, 'f', 2) + " per 1000 instructions)";
+  }
+  result += "\n  Branch misses: " + FormatCounter(branch_misses) + '\n';
+  if (task_clock >= 0) {
+    result += "  Task clock: " + QString::number(task_clock, 'f', 1) + "ms\n";
+  }
+  return result;
+}
+
+QString PerfCounters::FormatSummary() const {
+  QStringList stats;
+  if (double ipc = GetIpc(); ipc >= 0) {
+    stats.append("IPC " + QString::number(ipc, 'f', 2));
+  }
+  if (double mpki = GetCacheMpki(); mpki >= 0) {
+    stats.append("cache MPKI " + QString::number(mpki, 'f', 2));
+  }
+  return stats.join(", ");
+}
+
+static QString FormatChange(double value, double previous) {
+  double change = value - previous;
+  return QString(change >= 0 ? "+" : "-") +
+         QString::number(std::abs(change), 'f', 2);
+}
+
+QString PerfCounters::FormatComparison(const PerfCounters& previous,
+                                       bool& is_regression) const {
+  is_regression = false;
+  QStringList changes;
+  double ipc = GetIpc(), previous_ipc = previous.GetIpc();
+  if (ipc >= 0 && previous_ipc > 0) {
+    changes.append("IPC " + FormatChange(ipc, previous_ipc));
+    is_regression |= ipc < previous_ipc * (1 - kRegressionThreshold);
+  }
+  double mpki = GetCacheMpki(), previous_mpki = previous.GetCacheMpki();
+  if (mpki >= 0 && previous_mpki >= 0) {
+    changes.append("cache MPKI " + FormatChange(mpki, previous_mpki));
+    is_regression |= mpki > previous_mpki * (1 + kRegressionThreshold);
+  }
+  return changes.join(", ");
+}
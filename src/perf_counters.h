@@ -0,0 +1,40 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+/**
+ * Hardware counters of a process, collected by "perf stat". Counters, that
+ * are not supported by the CPU (or are not accessible to the user), are -1.
+ */
+struct PerfCounters {
+  // Events, that "perf stat" should count, in a format of its "-e" option.
+  static QString GetEvents();
+  // Parses the CSV, that "perf stat -x ," writes.
+  static PerfCounters ParseSync(const QString& path);
+  static PerfCounters Deserialize(const QByteArray& bytes);
+  QByteArray Serialize() const;
+  bool IsNull() const;
+  // Instructions per cycle.
+  double GetIpc() const;
+  // Cache misses per thousand instructions.
+  double GetCacheMpki() const;
+  QString FormatReport() const;
+  QString FormatSummary() const;
+  // Changes of IPC and cache misses compared to the specified counters, that
+  // are considered a regression when IPC gets lower or cache misses get more
+  // frequent by more than a few percent.
+  QString FormatComparison(const PerfCounters& previous,
+                           bool& is_regression) const;
+
+  qint64 cycles = -1;
+  qint64 instructions = -1;
+  qint64 cache_misses = -1;
+  qint64 branch_misses = -1;
+  // Milliseconds of CPU time.
+  double task_clock = -1;
+};
+
+#endif  // PERFCOUNTERS_H
@@ -7,19 +7,23 @@
 #define LOG() qDebug() << "[QTestExecutionModel]"
 
 QTestExecutionModel::QTestExecutionModel(QObject* parent)
-    : TestExecutionModel(parent), current_output_line(0), tests_seen(0) {
+    : TestExecutionModel(parent),
+      processes(1),
+      is_sharded(false),
+      output_size(0),
+      tests_seen(0) {
   Application& app = Application::Get();
   app.view.SetWindowTitle("QTest Execution");
-  connect(&app.task, &TaskSystem::executionOutputChanged, this,
-          [this, &app](QUuid id) {
+  connect(&app.task, &TaskSystem::executionOutputAppended, this,
+          [this, &app](QUuid id, int offset, const QString& data) {
             if (app.task.GetSelectedExecutionId() == id) {
-              ReloadExecution();
+              AppendOutput(offset, data);
             }
           });
   connect(&app.task, &TaskSystem::executionFinished, this,
           [this, &app](QUuid id) {
             if (app.task.GetSelectedExecutionId() == id) {
-              SetTestCount(-1);
+              FinishExecution();
             }
           });
   connect(this, &TestExecutionModel::rerunTest, this,
@@ -34,84 +38,153 @@ void QTestExecutionModel::ReloadExecution() {
   QUuid id = app.task.GetSelectedExecutionId();
   app.task.FetchExecution(id, true).Then(
       this, [this](const TaskExecution& exec) {
-        static const QRegularExpression kSuiteStartRegex(
-            "\\*+ Start testing of (.+) \\*+");
         this->exec = exec;
         emit taskNameChanged();
-        QStringList lines = exec.output.split('\n', Qt::SkipEmptyParts);
-        if (lines.size() < current_output_line) {
-          current_test_suite.clear();
-          current_test_case.clear();
-          current_output_line = 0;
-          tests_seen = 0;
-          Clear();
-        }
-        for (; current_output_line < lines.size(); current_output_line++) {
-          const QString& line = lines[current_output_line];
-          LOG() << "New raw line:" << line;
-          if (line.startsWith("Config: Using QtTest library") ||
-              line.startsWith("Totals: ") ||
-              line.startsWith("********* Finished")) {
-            continue;
-          }
-          QRegularExpressionMatch m = kSuiteStartRegex.match(line);
-          if (m.hasMatch()) {
-            current_test_suite = m.captured(1);
-            current_test_case.clear();
-            LOG() << "Test suite started:" << current_test_suite;
-            continue;
-          }
-          bool pass = line.startsWith("PASS");
-          bool fail = line.startsWith("FAIL");
-          if (pass || fail) {
-            StartCurrentTestCaseIfNecessary(line);
-            FinishCurrentTest(pass);
-            tests_seen++;
-            LOG() << "Test" << current_test_case << "passed:" << pass;
-            if (pass) {
-              // In case of fail - the line will have output on it
-              continue;
-            }
-          }
-          if (current_test_suite.isEmpty()) {
-            AppendTestPreparationOutput(line + '\n');
-            continue;
-          }
-          QString test_id_start = current_test_suite + "::";
-          int i = line.indexOf(test_id_start);
-          if (i < 0) {
-            if (!current_test_case.isEmpty()) {
-              AppendOutputToCurrentTest(line + '\n');
-            }
-          } else {
-            StartCurrentTestCaseIfNecessary(line);
-            QString test_id = test_id_start + current_test_case + "() ";
-            QString output = line.sliced(i + test_id.size());
-            AppendOutputToCurrentTest(output + '\n');
-          }
-        }
-        Load(GetRowCount() - 1);
+        processes = QList<QTestProcess>(1);
+        is_sharded = false;
+        output_size = exec.output.GetSize();
+        last_line.clear();
+        tests_seen = 0;
+        Clear();
+        ParseOutput(exec.output.GetText());
         if (exec.exit_code) {
-          SetTestCount(-1);
+          FinishExecution();
         }
       });
 }
 
-void QTestExecutionModel::StartCurrentTestCaseIfNecessary(const QString& line) {
-  QString prefix = ": " + current_test_suite + "::";
+void QTestExecutionModel::AppendOutput(int offset, const QString& data) {
+  int last_line_offset = output_size - last_line.size();
+  if (offset < last_line_offset || offset > output_size) {
+    // The output has been reset (e.g. the task is being re-run until it
+    // fails) so we need to start parsing it from scratch.
+    ReloadExecution();
+    return;
+  }
+  // Only the last line, that has not been parsed yet, can get overwritten.
+  last_line.truncate(offset - last_line_offset);
+  output_size = offset + data.size();
+  ParseOutput(data);
+}
+
+void QTestExecutionModel::ParseOutput(const QString& data) {
+  // Output arrives in arbitrary pieces, so the last line of it might not be
+  // complete yet: keep it until the rest of it arrives.
+  QString text = last_line + data;
+  int pos = 0;
+  while (true) {
+    int i = text.indexOf('\n', pos);
+    if (i < 0) {
+      break;
+    }
+    if (i > pos) {
+      ParseLine(text.sliced(pos, i - pos));
+    }
+    pos = i + 1;
+  }
+  last_line = text.sliced(pos);
+  Load(GetRowCount() - 1);
+}
+
+void QTestExecutionModel::ParseLine(const QString& line) {
+  static const QRegularExpression kShardedRunRegex("^\\[shards ([0-9]+)\\] ");
+  static const QRegularExpression kShardRegex(
+      "^\\[shard ([0-9]+)/[0-9]+\\] ");
+  LOG() << "New raw line:" << line;
+  QRegularExpressionMatch m = kShardedRunRegex.match(line);
+  if (m.hasMatch()) {
+    is_sharded = true;
+    processes = QList<QTestProcess>(std::max(m.captured(1).toInt(), 1));
+    AppendTestPreparationOutput(line + '\n');
+    return;
+  }
+  if (!is_sharded) {
+    ParseProcessLine(processes[0], line);
+    return;
+  }
+  m = kShardRegex.match(line);
+  if (!m.hasMatch()) {
+    AppendTestPreparationOutput(line + '\n');
+    return;
+  }
+  int i = m.captured(1).toInt();
+  if (i < processes.size()) {
+    ParseProcessLine(processes[i], line.sliced(m.capturedLength()));
+  }
+}
+
+void QTestExecutionModel::ParseProcessLine(QTestProcess& proc,
+                                           const QString& line) {
+  static const QRegularExpression kSuiteStartRegex(
+      "\\*+ Start testing of (.+) \\*+");
+  if (line.startsWith("Config: Using QtTest library") ||
+      line.startsWith("Totals: ") || line.startsWith("********* Finished")) {
+    return;
+  }
+  QRegularExpressionMatch m = kSuiteStartRegex.match(line);
+  if (m.hasMatch()) {
+    proc.current_test_suite = m.captured(1);
+    proc.current_test_case.clear();
+    LOG() << "Test suite started:" << proc.current_test_suite;
+    return;
+  }
+  bool pass = line.startsWith("PASS");
+  bool fail = line.startsWith("FAIL");
+  if (pass || fail) {
+    StartCurrentTestCaseIfNecessary(proc, line);
+    FinishTest(proc.current_test, pass);
+    tests_seen++;
+    LOG() << "Test" << proc.current_test_case << "passed:" << pass;
+    if (pass) {
+      // In case of fail - the line will have output on it
+      return;
+    }
+  }
+  if (proc.current_test_suite.isEmpty()) {
+    AppendTestPreparationOutput(line + '\n');
+    return;
+  }
+  QString test_id_start = proc.current_test_suite + "::";
+  int i = line.indexOf(test_id_start);
+  if (i < 0) {
+    if (!proc.current_test_case.isEmpty()) {
+      AppendOutputToTest(proc.current_test, line + '\n');
+    }
+  } else {
+    StartCurrentTestCaseIfNecessary(proc, line);
+    QString test_id = test_id_start + proc.current_test_case + "() ";
+    QString output = line.sliced(i + test_id.size());
+    AppendOutputToTest(proc.current_test, output + '\n');
+  }
+}
+
+void QTestExecutionModel::FinishExecution() {
+  if (!last_line.isEmpty()) {
+    ParseLine(last_line);
+    last_line.clear();
+    Load(GetRowCount() - 1);
+  }
+  SetTestCount(-1);
+}
+
+void QTestExecutionModel::StartCurrentTestCaseIfNecessary(
+    QTestProcess& proc, const QString& line) {
+  QString prefix = ": " + proc.current_test_suite + "::";
   int start = line.indexOf(prefix) + prefix.size();
   int end = line.indexOf("()", start);
   QString test_case = line.sliced(start, end - start);
-  if (current_test_case != test_case) {
-    current_test_case = test_case;
-    LOG() << "Test" << current_test_case << "started";
+  if (proc.current_test_case != test_case) {
+    proc.current_test_case = test_case;
+    LOG() << "Test" << proc.current_test_case << "started";
     QString rerun_id;
-    if (!current_test_case.startsWith("initTestCase") &&
-        current_test_case != "cleanupTestCase" && current_test_case != "init" &&
-        current_test_case != "cleanup") {
-      rerun_id = current_test_case;
+    if (!proc.current_test_case.startsWith("initTestCase") &&
+        proc.current_test_case != "cleanupTestCase" &&
+        proc.current_test_case != "init" &&
+        proc.current_test_case != "cleanup") {
+      rerun_id = proc.current_test_case;
     }
-    StartTest(current_test_suite, current_test_case, rerun_id);
+    proc.current_test = StartTest(proc.current_test_suite,
+                                  proc.current_test_case, rerun_id);
   }
 }
 
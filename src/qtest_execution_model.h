@@ -6,6 +6,14 @@
 #include "task_system.h"
 #include "test_execution_model.h"
 
+// State of parsing of output of a single test process. An execution, that has
+// been split into shards, has one per shard.
+struct QTestProcess {
+  QString current_test_suite;
+  QString current_test_case;
+  int current_test = -1;
+};
+
 class QTestExecutionModel : public TestExecutionModel {
   Q_OBJECT
   QML_ELEMENT
@@ -19,13 +27,20 @@ class QTestExecutionModel : public TestExecutionModel {
 
  private:
   void ReloadExecution();
-  void StartCurrentTestCaseIfNecessary(const QString& line);
+  void AppendOutput(int offset, const QString& data);
+  void ParseOutput(const QString& data);
+  void ParseLine(const QString& line);
+  void ParseProcessLine(QTestProcess& proc, const QString& line);
+  void FinishExecution();
+  void StartCurrentTestCaseIfNecessary(QTestProcess& proc,
+                                       const QString& line);
   void ReRunTestCase(const QString id, bool repeat_until_fail);
 
   TaskExecution exec;
-  QString current_test_suite;
-  QString current_test_case;
-  int current_output_line;
+  QList<QTestProcess> processes;
+  bool is_sharded;
+  int output_size;
+  QString last_line;
   int tests_seen;
 };
 
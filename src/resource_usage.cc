@@ -0,0 +1,234 @@
+#include "resource_usage.h"
+
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocale>
+#include <algorithm>
+
+#if __linux__
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+ResourceUsage ResourceUsage::Deserialize(const QByteArray& bytes) {
+  ResourceUsage usage;
+  QJsonObject o = QJsonDocument::fromJson(bytes).object();
+  usage.user_time = o["user_time"].toInteger();
+  usage.system_time = o["system_time"].toInteger();
+  usage.peak_rss = o["peak_rss"].toInteger();
+  usage.voluntary_context_switches =
+      o["voluntary_context_switches"].toInteger();
+  usage.involuntary_context_switches =
+      o["involuntary_context_switches"].toInteger();
+  usage.read_bytes = o["read_bytes"].toInteger();
+  usage.write_bytes = o["write_bytes"].toInteger();
+  return usage;
+}
+
+#if __linux__
+static QByteArray ReadProcFile(const QString& path) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return QByteArray();
+  }
+  // Files in /proc report their size as 0, so they have to be read until the
+  // end.
+  return file.readAll();
+}
+
+static qint64 ReadProcField(const QByteArray& text, const QByteArray& name) {
+  int i = text.indexOf('\n' + name + ':');
+  if (i < 0 && text.startsWith(name + ':')) {
+    i = -1;
+  } else if (i < 0) {
+    return 0;
+  }
+  int start = i + name.size() + 2;
+  int end = text.indexOf('\n', start);
+  QByteArray value = text.mid(start, end < 0 ? -1 : end - start).trimmed();
+  // Sizes in "status" are in kilobytes.
+  if (value.endsWith(" kB")) {
+    return value.chopped(3).trimmed().toLongLong() * 1024;
+  }
+  return value.toLongLong();
+}
+
+static void SampleProcessSync(qint64 pid, ResourceUsage& usage) {
+  static const qint64 kClockTicks = sysconf(_SC_CLK_TCK);
+  static const qint64 kPageSize = sysconf(_SC_PAGESIZE);
+  QString folder = "/proc/" + QString::number(pid);
+  QByteArray stat = ReadProcFile(folder + "/stat");
+  // Name of the executable is in parentheses and can contain anything, so
+  // fields are counted from the last closing parenthesis, starting with the
+  // 3rd one.
+  QList<QByteArray> fields = stat.mid(stat.lastIndexOf(')') + 2).split(' ');
+  if (fields.size() < 22) {
+    return;
+  }
+  auto to_ms = [](const QByteArray& ticks) {
+    return ticks.toLongLong() * 1000 / kClockTicks;
+  };
+  // Children, that have been reaped, are included in cutime and cstime.
+  usage.user_time += to_ms(fields[11]) + to_ms(fields[13]);
+  usage.system_time += to_ms(fields[12]) + to_ms(fields[14]);
+  usage.threads += fields[17].toInt();
+  qint64 rss = fields[21].toLongLong() * kPageSize;
+  usage.rss += rss;
+  QByteArray status = ReadProcFile(folder + "/status");
+  usage.peak_rss =
+      std::max({usage.peak_rss, rss, ReadProcField(status, "VmHWM")});
+  QByteArray io = ReadProcFile(folder + "/io");
+  usage.read_bytes += ReadProcField(io, "read_bytes");
+  usage.write_bytes += ReadProcField(io, "write_bytes");
+  // Context switches and children are tracked per thread.
+  QDir tasks(folder + "/task");
+  QStringList tids = tasks.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+  for (const QString& tid : tids) {
+    QString task_folder = tasks.filePath(tid);
+    QByteArray task_status = ReadProcFile(task_folder + "/status");
+    usage.voluntary_context_switches +=
+        ReadProcField(task_status, "voluntary_ctxt_switches");
+    usage.involuntary_context_switches +=
+        ReadProcField(task_status, "nonvoluntary_ctxt_switches");
+    QByteArray children = ReadProcFile(task_folder + "/children");
+    for (const QByteArray& child : children.split(' ')) {
+      if (qint64 child_pid = child.trimmed().toLongLong(); child_pid > 0) {
+        SampleProcessSync(child_pid, usage);
+      }
+    }
+  }
+}
+#endif
+
+ResourceUsage ResourceUsage::SampleProcessTreeSync(qint64 pid) {
+  ResourceUsage usage;
+#if __linux__
+  SampleProcessSync(pid, usage);
+  usage.peak_rss = std::max(usage.peak_rss, usage.rss);
+#else
+  Q_UNUSED(pid);
+#endif
+  return usage;
+}
+
+ResourceUsage ResourceUsage::GetReapedChildrenUsage() {
+  ResourceUsage usage;
+#if __linux__
+  rusage r;
+  if (getrusage(RUSAGE_CHILDREN, &r) != 0) {
+    return usage;
+  }
+  auto to_ms = [](const timeval& t) {
+    return t.tv_sec * 1000LL + t.tv_usec / 1000;
+  };
+  usage.user_time = to_ms(r.ru_utime);
+  usage.system_time = to_ms(r.ru_stime);
+  usage.peak_rss = r.ru_maxrss * 1024LL;
+  usage.voluntary_context_switches = r.ru_nvcsw;
+  usage.involuntary_context_switches = r.ru_nivcsw;
+  // I/O is counted in 512-byte blocks.
+  usage.read_bytes = r.ru_inblock * 512LL;
+  usage.write_bytes = r.ru_oublock * 512LL;
+#endif
+  return usage;
+}
+
+QByteArray ResourceUsage::Serialize() const {
+  QJsonObject o;
+  o["user_time"] = user_time;
+  o["system_time"] = system_time;
+  o["peak_rss"] = peak_rss;
+  o["voluntary_context_switches"] = voluntary_context_switches;
+  o["involuntary_context_switches"] = involuntary_context_switches;
+  o["read_bytes"] = read_bytes;
+  o["write_bytes"] = write_bytes;
+  return QJsonDocument(o).toJson(QJsonDocument::Compact);
+}
+
+bool ResourceUsage::IsNull() const {
+  return GetCpuTime() == 0 && peak_rss == 0 && rss == 0;
+}
+
+qint64 ResourceUsage::GetCpuTime() const { return user_time + system_time; }
+
+void ResourceUsage::Add(const ResourceUsage& another) {
+  cpu_percent += another.cpu_percent;
+  rss += another.rss;
+  threads += another.threads;
+  user_time += another.user_time;
+  system_time += another.system_time;
+  // Processes of different trees don't necessarily run at the same time.
+  peak_rss = std::max(peak_rss, another.peak_rss);
+  voluntary_context_switches += another.voluntary_context_switches;
+  involuntary_context_switches += another.involuntary_context_switches;
+  read_bytes += another.read_bytes;
+  write_bytes += another.write_bytes;
+}
+
+ResourceUsage ResourceUsage::GetReapedChildrenUsageSince(
+    const ResourceUsage& earlier) const {
+  ResourceUsage usage;
+  usage.user_time = user_time - earlier.user_time;
+  usage.system_time = system_time - earlier.system_time;
+  usage.peak_rss = peak_rss > earlier.peak_rss ? peak_rss : 0;
+  usage.voluntary_context_switches =
+      voluntary_context_switches - earlier.voluntary_context_switches;
+  usage.involuntary_context_switches =
+      involuntary_context_switches - earlier.involuntary_context_switches;
+  usage.read_bytes = read_bytes - earlier.read_bytes;
+  usage.write_bytes = write_bytes - earlier.write_bytes;
+  return usage;
+}
+
+void ResourceUsage::Merge(const ResourceUsage& another) {
+  user_time = std::max(user_time, another.user_time);
+  system_time = std::max(system_time, another.system_time);
+  peak_rss = std::max(peak_rss, another.peak_rss);
+  voluntary_context_switches =
+      std::max(voluntary_context_switches, another.voluntary_context_switches);
+  involuntary_context_switches = std::max(
+      involuntary_context_switches, another.involuntary_context_switches);
+  read_bytes = std::max(read_bytes, another.read_bytes);
+  write_bytes = std::max(write_bytes, another.write_bytes);
+}
+
+void ResourceUsage::ClearLiveValues() {
+  cpu_percent = 0;
+  rss = 0;
+  threads = 0;
+}
+
+static QString FormatTime(qint64 ms) {
+  return QString::number(ms / 1000.0, 'f', 1) + 's';
+}
+
+static QString FormatBytes(qint64 bytes) {
+  return QLocale::c().formattedDataSize(bytes, 1,
+                                        QLocale::DataSizeTraditionalFormat);
+}
+
+QList<std::pair<QString, QString>> ResourceUsage::GetStats(
+    bool is_running) const {
+  QList<std::pair<QString, QString>> stats;
+  if (is_running) {
+    stats.append({"CPU", QString::number(cpu_percent, 'f', 0) + '%'});
+    stats.append({"RSS", FormatBytes(rss)});
+    stats.append({"Threads", QString::number(threads)});
+  }
+  stats.append({"User Time", FormatTime(user_time)});
+  stats.append({"System Time", FormatTime(system_time)});
+  stats.append({"Peak RSS", FormatBytes(peak_rss)});
+  stats.append({"Context Switches",
+                QString::number(voluntary_context_switches) + " / " +
+                    QString::number(involuntary_context_switches)});
+  stats.append({"I/O", FormatBytes(read_bytes) + " read, " +
+                           FormatBytes(write_bytes) + " written"});
+  return stats;
+}
+
+QString ResourceUsage::FormatSummary() const {
+  return "CPU " + FormatTime(GetCpuTime()) + ", peak RSS " +
+         FormatBytes(peak_rss);
+}
@@ -0,0 +1,51 @@
+#ifndef RESOURCEUSAGE_H
+#define RESOURCEUSAGE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+/**
+ * Resources, used by a tree of processes. On Linux they are sampled from /proc
+ * while the processes are running. Processes, that have exited and have been
+ * reaped by their parents, are accounted for in their parents' times.
+ *
+ * QProcess reaps its processes by itself, so there is no way to wait4() them.
+ * Instead, final totals of a process are the difference in rusage of all the
+ * reaped children of the app before and after the process runs. It is only
+ * exact when no other child of the app gets reaped in the meantime.
+ */
+struct ResourceUsage {
+  // Live values, that only make sense while the processes are running.
+  double cpu_percent = 0;
+  qint64 rss = 0;
+  int threads = 0;
+  // Totals. Times are in milliseconds, sizes are in bytes.
+  qint64 user_time = 0;
+  qint64 system_time = 0;
+  qint64 peak_rss = 0;
+  qint64 voluntary_context_switches = 0;
+  qint64 involuntary_context_switches = 0;
+  qint64 read_bytes = 0;
+  qint64 write_bytes = 0;
+
+  static ResourceUsage Deserialize(const QByteArray& bytes);
+  static ResourceUsage SampleProcessTreeSync(qint64 pid);
+  // Totals of all the children of the app, that have been reaped so far.
+  // Peak RSS is the largest one among them.
+  static ResourceUsage GetReapedChildrenUsage();
+  QByteArray Serialize() const;
+  bool IsNull() const;
+  qint64 GetCpuTime() const;
+  void Add(const ResourceUsage& another);
+  // Totals of children, that have been reaped since the earlier usage. Peak
+  // RSS is only known if one of them has outgrown all the earlier children.
+  ResourceUsage GetReapedChildrenUsageSince(const ResourceUsage& earlier) const;
+  // Keeps the larger of each total.
+  void Merge(const ResourceUsage& another);
+  void ClearLiveValues();
+  QList<std::pair<QString, QString>> GetStats(bool is_running) const;
+  QString FormatSummary() const;
+};
+
+#endif  // RESOURCEUSAGE_H
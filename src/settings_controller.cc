@@ -64,10 +64,24 @@ void SettingsController::save() {
   cmds.append(shortcuts->MakeCommandsToUpdateDatabase());
   shortcuts->ResetAllModifications();
   app.task.context = TaskContext{settings.task_history_limit,
-                                 settings.run_with_console_on_win};
+                                 settings.run_with_console_on_win,
+                                 settings.task_output_refresh_interval,
+                                 settings.task_output_spill_threshold,
+                                 settings.run_in_pty,
+                                 settings.task_output_head_limit,
+                                 settings.task_output_tail_limit,
+                                 settings.task_job_limit,
+                                 settings.task_slow_build_step_threshold};
   cmds.append(Database::Cmd(
-      "UPDATE task_context SET history_limit=?, run_with_console_on_win=?",
-      {settings.task_history_limit, settings.run_with_console_on_win}));
+      "UPDATE task_context SET history_limit=?, run_with_console_on_win=?, "
+      "output_refresh_interval=?, output_spill_threshold=?, run_in_pty=?, "
+      "output_head_limit=?, output_tail_limit=?, job_limit=?, "
+      "slow_build_step_threshold=?",
+      {settings.task_history_limit, settings.run_with_console_on_win,
+       settings.task_output_refresh_interval,
+       settings.task_output_spill_threshold, settings.run_in_pty,
+       settings.task_output_head_limit, settings.task_output_tail_limit,
+       settings.task_job_limit, settings.task_slow_build_step_threshold}));
   for (int i = 0; i < terminals->list.size(); i++) {
     cmds.append(Database::Cmd("UPDATE terminal SET priority=? WHERE name=?",
                               {i, terminals->list[i]}));
@@ -101,11 +115,28 @@ void SettingsController::Load() {
             "SELECT * FROM documentation_folder", &Database::ReadStringFromSql);
         TaskContext context = Database::ExecQueryAndRead<TaskContext>(
                                   "SELECT history_limit, "
-                                  "run_with_console_on_win FROM task_context",
+                                  "run_with_console_on_win, "
+                                  "output_refresh_interval, "
+                                  "output_spill_threshold, "
+                                  "run_in_pty, "
+                                  "output_head_limit, "
+                                  "output_tail_limit, "
+                                  "job_limit, "
+                                  "slow_build_step_threshold "
+                                  "FROM task_context",
                                   &TaskSystem::ReadContextFromSql)
                                   .constFirst();
         settings.task_history_limit = context.history_limit;
         settings.run_with_console_on_win = context.run_with_console_on_win;
+        settings.task_output_refresh_interval =
+            context.output_refresh_interval;
+        settings.task_output_spill_threshold = context.output_spill_threshold;
+        settings.run_in_pty = context.run_in_pty;
+        settings.task_output_head_limit = context.output_head_limit;
+        settings.task_output_tail_limit = context.output_tail_limit;
+        settings.task_job_limit = context.job_limit;
+        settings.task_slow_build_step_threshold =
+            context.slow_build_step_threshold;
         settings.terminals = Database::ExecQueryAndRead<QString>(
             "SELECT name FROM terminal ORDER BY priority",
             &Database::ReadStringFromSql);
@@ -173,6 +204,15 @@ bool Settings::operator==(const Settings &another) const {
   return open_in_editor_command == another.open_in_editor_command &&
          task_history_limit == another.task_history_limit &&
          run_with_console_on_win == another.run_with_console_on_win &&
+         task_output_refresh_interval ==
+             another.task_output_refresh_interval &&
+         task_output_spill_threshold == another.task_output_spill_threshold &&
+         run_in_pty == another.run_in_pty &&
+         task_output_head_limit == another.task_output_head_limit &&
+         task_output_tail_limit == another.task_output_tail_limit &&
+         task_job_limit == another.task_job_limit &&
+         task_slow_build_step_threshold ==
+             another.task_slow_build_step_threshold &&
          external_search_folders == another.external_search_folders &&
          documentation_folders == another.documentation_folders &&
          terminals == another.terminals;
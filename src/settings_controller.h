@@ -49,6 +49,14 @@ struct Settings {
   Q_PROPERTY(QString openInEditorCommand MEMBER open_in_editor_command)
   Q_PROPERTY(int taskHistoryLimit MEMBER task_history_limit)
   Q_PROPERTY(bool shouldRunWithConsoleOnWin MEMBER run_with_console_on_win)
+  Q_PROPERTY(int taskOutputRefreshInterval MEMBER task_output_refresh_interval)
+  Q_PROPERTY(int taskOutputSpillThreshold MEMBER task_output_spill_threshold)
+  Q_PROPERTY(bool shouldRunInPty MEMBER run_in_pty)
+  Q_PROPERTY(int taskOutputHeadLimit MEMBER task_output_head_limit)
+  Q_PROPERTY(int taskOutputTailLimit MEMBER task_output_tail_limit)
+  Q_PROPERTY(int taskJobLimit MEMBER task_job_limit)
+  Q_PROPERTY(
+      int taskSlowBuildStepThreshold MEMBER task_slow_build_step_threshold)
  public:
   bool operator==(const Settings& another) const;
   bool operator!=(const Settings& another) const;
@@ -56,6 +64,13 @@ struct Settings {
   QString open_in_editor_command;
   int task_history_limit;
   bool run_with_console_on_win;
+  int task_output_refresh_interval;
+  int task_output_spill_threshold;
+  bool run_in_pty;
+  int task_output_head_limit;
+  int task_output_tail_limit;
+  int task_job_limit;
+  int task_slow_build_step_threshold;
   QStringList external_search_folders;
   QStringList documentation_folders;
   QStringList terminals;
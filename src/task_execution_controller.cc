@@ -9,21 +9,55 @@ TaskExecutionController::TaskExecutionController(QObject* parent)
       execution_formatter(new TaskExecutionOutputFormatter(this)) {
   Application& app = Application::Get();
   app.view.SetWindowTitle("Task Execution Output");
-  QObject::connect(&app.task, &TaskSystem::executionOutputChanged, this,
+  QObject::connect(
+      &app.task, &TaskSystem::executionOutputAppended, this,
+      [this, &app](QUuid id, int offset, const QString& data,
+                   const QList<std::pair<int, int>>& stderr_ranges,
+                   const LineTimes& line_times) {
+        if (app.task.GetSelectedExecutionId() != id) {
+          return;
+        }
+        if (const TaskExecution* exec = app.task.FindExecutionById(id)) {
+          AppendExecutionOutput(*exec, offset, data, stderr_ranges,
+                                line_times);
+        }
+      });
+  QObject::connect(&app.task, &TaskSystem::executionFinished, this,
                    [this, &app](QUuid id) {
                      if (app.task.GetSelectedExecutionId() == id) {
-                       LoadExecution(true);
+                       LoadExecution(false);
                      }
                    });
-  QObject::connect(&app.task, &TaskSystem::executionFinished, this,
-                   [this, &app](QUuid id) {
+  QObject::connect(&app.task, &TaskSystem::executionResourceUsageChanged,
+                   this, [this, &app](QUuid id) {
                      if (app.task.GetSelectedExecutionId() == id) {
                        LoadExecution(false);
                      }
                    });
+  QObject::connect(&app.task, &TaskSystem::executionBuildProgressChanged,
+                   this, [this, &app](QUuid id) {
+                     if (app.task.GetSelectedExecutionId() != id) {
+                       return;
+                     }
+                     const TaskExecution* exec = app.task.FindExecutionById(id);
+                     if (exec && DisplayExecutionStatus(*exec)) {
+                       emit executionChanged();
+                     }
+                   });
+  // Tasks, that are run on changes, select their new runs by themselves.
+  QObject::connect(&app.task, &TaskSystem::selectedExecutionChanged, this,
+                   [this] { LoadExecution(true); });
   LoadExecution(true);
 }
 
+QVariant TaskExecutionController::GetExecutionOutput() const {
+  return QVariant::fromValue(execution_output);
+}
+
+QVariant TaskExecutionController::GetExecutionLineTimes() const {
+  return QVariant::fromValue(execution_line_times);
+}
+
 void TaskExecutionController::LoadExecution(bool include_output) {
   LOG() << "Reloading selected execution including output:" << include_output;
   Application& app = Application::Get();
@@ -31,25 +65,85 @@ void TaskExecutionController::LoadExecution(bool include_output) {
   app.task.FetchExecution(id, include_output)
       .Then(this, [this, include_output](const TaskExecution& exec) {
         execution_name = exec.task_name;
-        execution_status = "<b>Running...</b>";
-        if (exec.exit_code) {
-          execution_status =
-              "Exit Code: <b>" + QString::number(*exec.exit_code) + "</b>";
-        }
-        execution_status +=
-            "&nbsp;&nbsp;&nbsp;Start Time: <b>" +
-            exec.start_time.toString(Application::kDateTimeFormat) + "</b>";
+        DisplayExecutionStatus(exec);
         UiIcon icon = exec.GetStatusAsIcon();
         execution_icon = icon.icon;
         execution_icon_color = icon.color;
         if (include_output) {
           execution_output = exec.output;
+          execution_line_times = exec.line_times;
           execution_formatter->stderr_line_indicies = exec.stderr_line_indices;
+          emit executionOutputReloaded();
+          emit executionOutputChanged();
         }
         emit executionChanged();
       });
 }
 
+bool TaskExecutionController::DisplayExecutionStatus(
+    const TaskExecution& exec) {
+  QString status = "<b>Running...</b>";
+  if (exec.exit_code) {
+    status = "Exit Code: <b>" + QString::number(*exec.exit_code) + "</b>";
+  }
+  status += "&nbsp;&nbsp;&nbsp;Start Time: <b>" +
+            exec.start_time.toString(Application::kDateTimeFormat) + "</b>";
+  if (exec.elided_line_count > 0) {
+    status += "&nbsp;&nbsp;&nbsp;Elided Lines: <b>" +
+              QString::number(exec.elided_line_count) + "</b>";
+  }
+  if (!exec.resource_usage.IsNull()) {
+    for (const auto& [name, value] :
+         exec.resource_usage.GetStats(!exec.exit_code)) {
+      status += "&nbsp;&nbsp;&nbsp;" + name + ": <b>" + value + "</b>";
+    }
+  }
+  // Progress of a build is only known while it is running.
+  double progress = -1;
+  if (!exec.exit_code && !exec.build_progress.IsNull()) {
+    for (const auto& [name, value] : exec.build_progress.GetStats()) {
+      status += "&nbsp;&nbsp;&nbsp;" + name + ": <b>" + value + "</b>";
+    }
+    progress = exec.build_progress.GetProgress();
+  }
+  QString slow_steps;
+  if (!exec.exit_code && !exec.build_progress.slow_steps.isEmpty()) {
+    slow_steps = "Slow Steps: " + exec.build_progress.FormatSlowSteps(5);
+  }
+  if (status == execution_status && progress == build_progress &&
+      slow_steps == slow_build_steps) {
+    return false;
+  }
+  execution_status = status;
+  build_progress = progress;
+  slow_build_steps = slow_steps;
+  return true;
+}
+
+void TaskExecutionController::AppendExecutionOutput(
+    const TaskExecution& exec, int offset, const QString& data,
+    const QList<std::pair<int, int>>& stderr_ranges,
+    const LineTimes& line_times) {
+  if (offset > execution_output.GetSize() ||
+      !execution_output.IsContinuedBy(exec.output)) {
+    // The output has been reset (e.g. the task is being re-run until it
+    // fails) and what we have displayed so far is no longer relevant.
+    LoadExecution(true);
+    return;
+  }
+  for (auto [first, last] : stderr_ranges) {
+    execution_formatter->stderr_line_indicies.Insert(first, last);
+  }
+  execution_output = exec.output;
+  emit executionOutputAppended(offset, data);
+  emit executionOutputChanged();
+  emit executionLineTimesAppended(execution_output.GetLineWithOffset(offset),
+                                  QVariant::fromValue(line_times));
+  if (DisplayExecutionStatus(exec)) {
+    emit executionChanged();
+  }
+}
+
 TaskExecutionOutputFormatter::TaskExecutionOutputFormatter(QObject* parent)
     : TextFormatter(parent) {
   error_line_format.setForeground(QBrush(Qt::red));
@@ -58,7 +152,7 @@ TaskExecutionOutputFormatter::TaskExecutionOutputFormatter(QObject* parent)
 QList<TextFormat> TaskExecutionOutputFormatter::Format(const QString& text,
                                                        LineInfo line) const {
   QList<TextFormat> results;
-  if (stderr_line_indicies.contains(line.number)) {
+  if (stderr_line_indicies.Contains(line.number)) {
     TextFormat f;
     f.offset = 0;
     f.length = text.size();
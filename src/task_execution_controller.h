@@ -3,6 +3,7 @@
 #include <QObject>
 #include <QtQmlIntegration>
 
+#include "task_system.h"
 #include "text_area_controller.h"
 
 class TaskExecutionOutputFormatter : public TextFormatter {
@@ -10,7 +11,7 @@ class TaskExecutionOutputFormatter : public TextFormatter {
   explicit TaskExecutionOutputFormatter(QObject* parent);
   QList<TextFormat> Format(const QString& text, LineInfo line) const;
 
-  QSet<int> stderr_line_indicies;
+  IntervalSet stderr_line_indicies;
   QTextCharFormat error_line_format;
 };
 
@@ -25,23 +26,44 @@ class TaskExecutionController : public QObject {
       QString executionIcon MEMBER execution_icon NOTIFY executionChanged)
   Q_PROPERTY(QString executionIconColor MEMBER execution_icon_color NOTIFY
                  executionChanged)
+  Q_PROPERTY(double buildProgress MEMBER build_progress NOTIFY executionChanged)
   Q_PROPERTY(
-      QString executionOutput MEMBER execution_output NOTIFY executionChanged)
+      QString slowBuildSteps MEMBER slow_build_steps NOTIFY executionChanged)
+  Q_PROPERTY(QVariant executionOutput READ GetExecutionOutput NOTIFY
+                 executionOutputChanged)
+  Q_PROPERTY(QVariant executionLineTimes READ GetExecutionLineTimes NOTIFY
+                 executionOutputReloaded)
   Q_PROPERTY(TaskExecutionOutputFormatter* executionFormatter MEMBER
                  execution_formatter CONSTANT)
  public:
   explicit TaskExecutionController(QObject* parent = nullptr);
+  QVariant GetExecutionOutput() const;
+  QVariant GetExecutionLineTimes() const;
 
  signals:
   void executionChanged();
+  void executionOutputChanged();
+  void executionOutputReloaded();
+  void executionOutputAppended(int offset, const QString& data);
+  void executionLineTimesAppended(int first_line, const QVariant& line_times);
 
  private:
   void LoadExecution(bool include_output);
+  bool DisplayExecutionStatus(const TaskExecution& exec);
+  void AppendExecutionOutput(const TaskExecution& exec, int offset,
+                             const QString& data,
+                             const QList<std::pair<int, int>>& stderr_ranges,
+                             const LineTimes& line_times);
 
   QString execution_name;
   QString execution_status;
-  QString execution_output;
+  TextBuffer execution_output;
+  // Times of lines, that arrive after the output has been loaded, are only
+  // sent to views as deltas.
+  LineTimes execution_line_times;
   QString execution_icon;
   QString execution_icon_color;
+  double build_progress = -1;
+  QString slow_build_steps;
   TaskExecutionOutputFormatter* execution_formatter;
 };
@@ -1,14 +1,18 @@
 #include "task_execution_list_model.h"
 
 #include "application.h"
-#include "database.h"
 #include "io_task.h"
 
 #define LOG() qDebug() << "[TaskExecutionListController]"
 
 TaskExecutionListModel::TaskExecutionListModel(QObject* parent)
     : TextListModel(parent) {
-  SetRoleNames({{0, "title"}, {1, "subTitle"}, {2, "icon"}, {3, "iconColor"}});
+  SetRoleNames({{0, "title"},
+                {1, "subTitle"},
+                {2, "icon"},
+                {3, "iconColor"},
+                {4, "rightText"},
+                {5, "rightTextColor"}});
   searchable_roles = {0, 1};
   SetEmptyListPlaceholder("No tasks have been executed yet");
   Application& app = Application::Get();
@@ -31,9 +35,25 @@ TaskExecutionListModel::TaskExecutionListModel(QObject* parent)
 QVariantList TaskExecutionListModel::GetRow(int i) const {
   const TaskExecution& exec = list[i];
   UiIcon icon = exec.GetStatusAsIcon();
-  return {exec.task_name,
-          exec.start_time.toString(Application::kDateTimeFormat), icon.icon,
-          icon.color};
+  QString details = exec.start_time.toString(Application::kDateTimeFormat);
+  if (!exec.resource_usage.IsNull()) {
+    details += "  " + exec.resource_usage.FormatSummary();
+  }
+  if (!exec.perf_counters.IsNull()) {
+    details += "  " + exec.perf_counters.FormatSummary();
+  }
+  // Counters are compared with the previous measured run of the same task.
+  QString comparison, comparison_color;
+  if (int j = previous_measured_execution[i]; j >= 0) {
+    bool is_regression = false;
+    comparison = exec.perf_counters.FormatComparison(list[j].perf_counters,
+                                                     is_regression);
+    if (is_regression) {
+      comparison_color = "red";
+    }
+  }
+  return {exec.task_name, details,    icon.icon,
+          icon.color,     comparison, comparison_color};
 }
 
 int TaskExecutionListModel::GetRowCount() const { return list.size(); }
@@ -45,6 +65,18 @@ void TaskExecutionListModel::Reload() {
   app.task.FetchExecutions(current_project.id)
       .Then(this, [this, &app](const QList<TaskExecution>& result) {
         list = result;
+        previous_measured_execution.clear();
+        QHash<TaskId, int> last_measured_execution;
+        for (int i = 0; i < list.size(); i++) {
+          const TaskExecution& exec = list[i];
+          previous_measured_execution.append(
+              exec.perf_counters.IsNull()
+                  ? -1
+                  : last_measured_execution.value(exec.task_id, -1));
+          if (!exec.perf_counters.IsNull()) {
+            last_measured_execution[exec.task_id] = i;
+          }
+        }
         if (app.task.GetSelectedExecutionId().isNull() && !list.isEmpty()) {
           app.task.SetSelectedExecutionId(list.last().id);
         }
@@ -83,8 +115,7 @@ void TaskExecutionListModel::removeFinishedExecutions() {
   IoTask::Run(
       this,
       [project_id] {
-        Database::ExecCmd("DELETE FROM task_execution WHERE project_id=?",
-                          {project_id});
+        TaskSystem::RemoveExecutionsSync("project_id=?", {project_id});
       },
       [this] { Reload(); });
 }
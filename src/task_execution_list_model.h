@@ -19,6 +19,9 @@ class TaskExecutionListModel : public TextListModel {
   bool IsSelectedExecutionRunning() const;
 
   QList<TaskExecution> list;
+  // Index of the previous execution of the same task, that has measured
+  // hardware counters, for each execution, that has measured them too.
+  QList<int> previous_measured_execution;
 
  public slots:
   void rerunSelectedExecution(bool repeat_until_fail, const QString& view);
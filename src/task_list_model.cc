@@ -13,6 +13,8 @@ struct TasksInfo {
   QStringList cmake_source_folders;
   QStringList cmake_cmake_file_replies;
   QStringList cmake_target_replies;
+  QStringList pipeline_files;
+  QStringList batch_build_files;
 };
 
 static void ScanFile(TasksInfo &info, const QString &root, QString path,
@@ -24,6 +26,10 @@ static void ScanFile(TasksInfo &info, const QString &root, QString path,
     info.cmake_build_folders.append(Path::GetFolderPath(path));
   } else if (file_info.fileName() == "CMakeLists.txt") {
     info.cmake_source_folders.append(Path::GetFolderPath(path));
+  } else if (file_info.fileName() == "cdt-pipelines.json") {
+    info.pipeline_files.append(path);
+  } else if (file_info.fileName() == "cdt-batch-builds.json") {
+    info.batch_build_files.append(path);
   } else if (Path::MatchesWildcard(
                  path, "*/.cmake/api/v1/reply/cmakeFiles-v1-*.json")) {
     info.cmake_cmake_file_replies.append(path);
@@ -155,14 +161,170 @@ static void CreateCmakeTasks(TasksInfo &info, const QString &project_path,
         continue;
       }
       entt::entity entity = registry.create();
-      registry.emplace<TaskId>(
-          entity, "cmake-target:" + target + ':' + exec_path + ':' +
-                      build_folder + ':' + QString::number(run_after_build));
       auto &t = registry.emplace<CmakeTargetTask>(entity);
       t.target_name = target;
       t.build_folder = build_folder;
       t.executable = exec_path;
       t.run_after_build = run_after_build;
+      registry.emplace<TaskId>(entity, t.GetId());
+      tasks.append(entity);
+    }
+  }
+}
+
+static QString ResolvePath(const QString &folder, const QString &path,
+                           bool is_folder) {
+  QString result = QDir::cleanPath(
+      QDir::isAbsolutePath(path) ? path : folder + path);
+  if (!QDir::isAbsolutePath(result)) {
+    result = result == "." ? "./" : "./" + result;
+  }
+  if (is_folder && !result.endsWith('/')) {
+    result += '/';
+  }
+  return result;
+}
+
+static CmakeBatchBuildTask ReadBatchBuild(const QJsonObject &o,
+                                          const QString &folder) {
+  CmakeBatchBuildTask t;
+  t.build_folder = ResolvePath(folder, o["folder"].toString(), true);
+  for (const QJsonValue &target : o["targets"].toArray()) {
+    t.target_names.append(target.toString());
+  }
+  t.jobs = o["jobs"].toInt();
+  return t;
+}
+
+static bool ReadPipelineStep(
+    const QJsonObject &o, const QString &folder,
+    const QHash<QString, CmakeTargetTask> &cmake_targets,
+    PipelineTask::Step &step) {
+  step.name = o["name"].toString();
+  for (const QJsonValue &name : o["after"].toArray()) {
+    step.after.append(name.toString());
+  }
+  // Tasks of steps are identified the same way as tasks, that we find in the
+  // project, so that running one of them while the other one is running
+  // doesn't run the same thing twice.
+  QJsonObject task;
+  if (o.contains("cmake")) {
+    QJsonObject cmake = o["cmake"].toObject();
+    CmakeTask t{
+        ResolvePath(folder, cmake["source"].toString(), true),
+        ResolvePath(folder, cmake["build"].toString(), true),
+    };
+    step.task_id = t.GetId();
+    task["source_path"] = t.source_path;
+    task["build_path"] = t.build_path;
+  } else if (o.contains("build") && o["build"]["targets"].isArray()) {
+    CmakeBatchBuildTask t = ReadBatchBuild(o["build"].toObject(), folder);
+    step.task_id = t.GetId();
+    task["build_folder"] = t.build_folder;
+    task["target_names"] = QJsonArray::fromStringList(t.target_names);
+    task["jobs"] = t.jobs;
+  } else if (o.contains("build")) {
+    QJsonObject build = o["build"].toObject();
+    CmakeTargetTask t;
+    t.build_folder = ResolvePath(folder, build["folder"].toString(), true);
+    t.target_name = build["target"].toString();
+    // Executables of targets are only known from replies of CMake.
+    t.executable =
+        cmake_targets.value(t.build_folder + ':' + t.target_name).executable;
+    step.task_id = t.GetId();
+    task["build_folder"] = t.build_folder;
+    task["target_name"] = t.target_name;
+    task["executable"] = t.executable;
+    task["run_after_build"] = t.run_after_build;
+  } else if (o.contains("run")) {
+    QJsonObject run = o["run"].toObject();
+    QString path = ResolvePath(folder, run["path"].toString(), false);
+    step.task_id = "exec:" + path;
+    task["path"] = path;
+    task["args"] = run["args"].toArray();
+  } else {
+    return false;
+  }
+  step.task_data = QJsonDocument(task).toJson();
+  if (o.contains("output_limits")) {
+    QJsonObject limits = o["output_limits"].toObject();
+    step.output_limits =
+        OutputLimits{limits["head"].toInt(), limits["tail"].toInt()};
+  }
+  return true;
+}
+
+static void CreatePipelineTasks(const TasksInfo &info,
+                                entt::registry &registry,
+                                QList<entt::entity> &tasks) {
+  QHash<QString, CmakeTargetTask> cmake_targets;
+  for (auto [_, t] : registry.view<const CmakeTargetTask>().each()) {
+    cmake_targets[t.build_folder + ':' + t.target_name] = t;
+  }
+  // Each file contains an object, where keys are names of pipelines and values
+  // are arrays of their steps.
+  for (const QString &path : info.pipeline_files) {
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) {
+      continue;
+    }
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(f.readAll(), &error);
+    if (!doc.isObject()) {
+      LOG() << "Failed to read pipelines from" << path << ":"
+            << error.errorString();
+      continue;
+    }
+    QString folder = Path::GetFolderPath(path);
+    QJsonObject pipelines = doc.object();
+    for (auto it = pipelines.begin(); it != pipelines.end(); it++) {
+      PipelineTask pipeline;
+      pipeline.name = it.key();
+      for (const QJsonValue &value : it.value().toArray()) {
+        PipelineTask::Step step;
+        if (ReadPipelineStep(value.toObject(), folder, cmake_targets, step)) {
+          pipeline.steps.append(step);
+        } else {
+          LOG() << "Step" << step.name << "of pipeline" << pipeline.name
+                << "in" << path << "has no task";
+        }
+      }
+      entt::entity entity = registry.create();
+      registry.emplace<TaskId>(entity, "pipeline:" + path + ':' + it.key());
+      registry.emplace<PipelineTask>(entity, pipeline);
+      tasks.append(entity);
+    }
+  }
+}
+
+static void CreateBatchBuildTasks(const TasksInfo &info,
+                                  entt::registry &registry,
+                                  QList<entt::entity> &tasks) {
+  // Each file contains an array of batch builds, each of which has a build
+  // folder, targets to build and optionally a number of parallel jobs.
+  for (const QString &path : info.batch_build_files) {
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) {
+      continue;
+    }
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(f.readAll(), &error);
+    if (!doc.isArray()) {
+      LOG() << "Failed to read batch builds from" << path << ":"
+            << error.errorString();
+      continue;
+    }
+    QString folder = Path::GetFolderPath(path);
+    for (const QJsonValue &value : doc.array()) {
+      CmakeBatchBuildTask t = ReadBatchBuild(value.toObject(), folder);
+      if (t.target_names.isEmpty()) {
+        LOG() << "Batch build of" << t.build_folder << "in" << path
+              << "has no targets";
+        continue;
+      }
+      entt::entity entity = registry.create();
+      registry.emplace<TaskId>(entity, t.GetId());
+      registry.emplace<CmakeBatchBuildTask>(entity, t);
       tasks.append(entity);
     }
   }
@@ -265,6 +427,8 @@ void TaskListModel::displayTaskList() {
         }
         CreateExecutableTasks(info, *task_registry, *task_entities);
         CreateCmakeTasks(info, project_path, *task_registry, *task_entities);
+        CreatePipelineTasks(info, *task_registry, *task_entities);
+        CreateBatchBuildTasks(info, *task_registry, *task_entities);
         SortFoundTasks(*task_registry, *task_entities, active_execs,
                        project_id);
       },
@@ -278,6 +442,9 @@ void TaskListModel::displayTaskList() {
           CopyTaskComp<ExecutableTask>(*task_registry, registry, entity, e);
           CopyTaskComp<CmakeTask>(*task_registry, registry, entity, e);
           CopyTaskComp<CmakeTargetTask>(*task_registry, registry, entity, e);
+          CopyTaskComp<CmakeBatchBuildTask>(*task_registry, registry, entity,
+                                            e);
+          CopyTaskComp<PipelineTask>(*task_registry, registry, entity, e);
         }
         Load(-1);
         SetPlaceholder();
@@ -306,7 +473,123 @@ void TaskListModel::executeCurrentTask(bool repeat_until_fail,
     ExecutableTask t = registry.get<ExecutableTask>(e);
     t.args = args;
     app.task.RunTask(registry.get<TaskId>(e), t, repeat_until_fail, view);
+  } else if (registry.any_of<CmakeBatchBuildTask>(e)) {
+    app.task.RunTask(registry.get<TaskId>(e),
+                     registry.get<CmakeBatchBuildTask>(e), repeat_until_fail,
+                     view);
+  } else if (registry.any_of<PipelineTask>(e)) {
+    app.task.RunPipeline(registry.get<TaskId>(e),
+                         registry.get<PipelineTask>(e));
+  }
+}
+
+void TaskListModel::executeCurrentTaskUntilFailInParallel() {
+  ExecuteCurrentTaskInParallel(ParallelMode::kStress, "TaskExecution.qml");
+}
+
+void TaskListModel::executeCurrentTaskAsGtestInShards() {
+  ExecuteCurrentTaskInParallel(ParallelMode::kGtestShards,
+                               "GtestExecution.qml");
+}
+
+void TaskListModel::executeCurrentTaskAsQtestInParallel() {
+  ExecuteCurrentTaskInParallel(ParallelMode::kQtestFunctions,
+                               "QtestExecution.qml");
+}
+
+void TaskListModel::ExecuteCurrentTaskInParallel(ParallelMode parallel,
+                                                 const QString &view) {
+  Application &app = Application::Get();
+  int i = GetSelectedItemIndex();
+  if (i < 0) {
+    return;
+  }
+  entt::entity e = tasks[i];
+  LOG() << "Executing task" << registry.get<TaskId>(e) << "in parallel mode"
+        << static_cast<int>(parallel);
+  bool repeat_until_fail = parallel == ParallelMode::kStress;
+  if (registry.any_of<CmakeTargetTask>(e)) {
+    app.task.RunTask(registry.get<TaskId>(e), registry.get<CmakeTargetTask>(e),
+                     repeat_until_fail, view, parallel);
+  } else if (registry.any_of<ExecutableTask>(e)) {
+    app.task.RunTask(registry.get<TaskId>(e), registry.get<ExecutableTask>(e),
+                     repeat_until_fail, view, parallel);
+  }
+}
+
+void TaskListModel::executeCurrentTaskOnChanges() {
+  Application &app = Application::Get();
+  int i = GetSelectedItemIndex();
+  if (i < 0) {
+    return;
+  }
+  entt::entity e = tasks[i];
+  LOG() << "Executing task" << registry.get<TaskId>(e) << "on changes";
+  if (registry.any_of<CmakeTargetTask>(e)) {
+    app.task.RunTaskOnChanges(registry.get<TaskId>(e),
+                              registry.get<CmakeTargetTask>(e),
+                              "TaskExecution.qml");
+  } else if (registry.any_of<ExecutableTask>(e)) {
+    app.task.RunTaskOnChanges(registry.get<TaskId>(e),
+                              registry.get<ExecutableTask>(e),
+                              "TaskExecution.qml");
+  }
+}
+
+void TaskListModel::executeCurrentTaskWithProfiling() {
+  Application &app = Application::Get();
+  int i = GetSelectedItemIndex();
+  if (i < 0) {
+    return;
+  }
+  entt::entity e = tasks[i];
+  if (registry.any_of<CmakeTask>(e)) {
+    LOG() << "Executing task" << registry.get<TaskId>(e) << "with profiling";
+    CmakeTask t = registry.get<CmakeTask>(e);
+    t.profile = true;
+    app.task.RunTask(t.GetId(), t, false, "TaskExecution.qml");
+  } else {
+    ExecuteCurrentTaskWithProfiler(Profiler::kSampling, "FlameGraph.qml");
+  }
+}
+
+void TaskListModel::executeCurrentTaskWithCounters() {
+  ExecuteCurrentTaskWithProfiler(Profiler::kCounters, "TaskExecution.qml");
+}
+
+void TaskListModel::executeCurrentTaskWithAllocationProfiling() {
+  ExecuteCurrentTaskWithProfiler(Profiler::kAllocations,
+                                 "AllocationProfile.qml");
+}
+
+void TaskListModel::ExecuteCurrentTaskWithProfiler(Profiler profiler,
+                                                   const QString &view) {
+#if __linux__
+  Application &app = Application::Get();
+  int i = GetSelectedItemIndex();
+  if (i < 0) {
+    return;
   }
+  entt::entity e = tasks[i];
+  LOG() << "Executing task" << registry.get<TaskId>(e) << "with profiler"
+        << static_cast<int>(profiler);
+  if (registry.any_of<CmakeTargetTask>(e)) {
+    CmakeTargetTask t = registry.get<CmakeTargetTask>(e);
+    if (!t.run_after_build) {
+      return;
+    }
+    t.profiler = profiler;
+    app.task.RunTask(registry.get<TaskId>(e), t, false, view);
+  } else if (registry.any_of<ExecutableTask>(e)) {
+    ExecutableTask t = registry.get<ExecutableTask>(e);
+    t.profiler = profiler;
+    app.task.RunTask(registry.get<TaskId>(e), t, false, view);
+  }
+#else
+  Q_UNUSED(profiler);
+  Q_UNUSED(view);
+  LOG() << "Profiling executables is only supported on Linux";
+#endif
 }
 
 QVariantList TaskListModel::GetRow(int i) const {
@@ -325,6 +608,22 @@ QVariantList TaskListModel::GetRow(int i) const {
     auto &t = registry.get<CmakeTargetTask>(e);
     details = "cmake --build " + t.build_folder + " -t " + t.target_name;
     icon = "change_history";
+  } else if (registry.any_of<CmakeBatchBuildTask>(e)) {
+    auto &t = registry.get<CmakeBatchBuildTask>(e);
+    details = "cmake --build " + t.build_folder;
+    if (t.jobs > 0) {
+      details += " -j " + QString::number(t.jobs);
+    }
+    details += " -t " + t.target_names.join(' ');
+    icon = "change_history";
+  } else if (registry.any_of<PipelineTask>(e)) {
+    auto &t = registry.get<PipelineTask>(e);
+    QStringList steps;
+    for (const PipelineTask::Step &step : t.steps) {
+      steps.append(step.name);
+    }
+    details = steps.join(", ");
+    icon = "device_hub";
   } else {
     details = registry.get<TaskId>(e);
     icon = "code";
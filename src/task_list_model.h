@@ -4,6 +4,7 @@
 #include <QtQmlIntegration>
 #include <entt.hpp>
 
+#include "task_system.h"
 #include "text_list_model.h"
 
 class TaskListModel : public TextListModel {
@@ -17,12 +18,23 @@ public slots:
   void displayTaskList();
   void executeCurrentTask(bool repeat_until_fail, const QString &view,
                           const QStringList &args);
+  void executeCurrentTaskUntilFailInParallel();
+  void executeCurrentTaskAsGtestInShards();
+  void executeCurrentTaskAsQtestInParallel();
+  void executeCurrentTaskOnChanges();
+  void executeCurrentTaskWithProfiling();
+  void executeCurrentTaskWithCounters();
+  void executeCurrentTaskWithAllocationProfiling();
 
 protected:
   QVariantList GetRow(int i) const override;
   int GetRowCount() const override;
 
 private:
+  void ExecuteCurrentTaskInParallel(ParallelMode parallel,
+                                    const QString &view);
+  void ExecuteCurrentTaskWithProfiler(Profiler profiler, const QString &view);
+
   entt::registry registry;
   QList<entt::entity> tasks;
   std::atomic_bool cancel;
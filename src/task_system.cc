@@ -4,14 +4,226 @@
 #include <windows.h>
 #endif
 
+#if __linux__
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <QSocketNotifier>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#endif
+
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QStringDecoder>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <unordered_map>
+
 #include "application.h"
 #include "database.h"
+#include "build_report.h"
 #include "io_task.h"
+#include "ninja_log.h"
 #include "path.h"
 #include "theme.h"
 
 #define LOG() qDebug() << "[TaskSystem]"
 
+// Output of an execution, that has been read from its process but is not yet
+// published. Processes can print thousands of small pieces of output per
+// second, while there is no point in updating views more often than they are
+// redrawn. Pieces are kept in the order they were read in, so that stdout and
+// stderr stay correctly interleaved.
+struct PendingOutput {
+  QList<std::pair<QString, bool>> pieces;
+  QStringDecoder stdout_decoder = QStringDecoder(QStringDecoder::Utf8);
+  QStringDecoder stderr_decoder = QStringDecoder(QStringDecoder::Utf8);
+  bool publish_scheduled = false;
+  // Pieces get published long after they arrive, so times of their lines
+  // are taken when they arrive.
+  QElapsedTimer clock;
+  QList<quint32> line_end_times;
+  quint32 last_piece_time = 0;
+};
+
+// Output of an execution, that has outgrown its budget, consists of its first
+// lines (head), a line, that says how much output has been elided, and its
+// last lines (tail), that start at tail_offset.
+struct ElidedOutput {
+  int head_size = 0;
+  int head_line_count = 0;
+  int tail_offset = 0;
+  int tail_line = 0;
+};
+
+// Execution of a pipeline, that lasts until all of its steps finish.
+struct PipelineRun {
+  QString name;
+  QDateTime start_time;
+  int unfinished_steps = 0;
+  QString failed_step;
+};
+
+// Task, that is a step of a running pipeline. It gets executed once all the
+// steps, it depends on, succeed and the number of running tasks is below the
+// job limit.
+struct PipelineStep {
+  entt::entity pipeline;
+  QString name;
+  int index = 0;
+  int unfinished_dependencies = 0;
+  QList<entt::entity> dependents;
+  bool started = false;
+};
+
+// Pipeline steps, that wait for an already running execution of the same task
+// instead of running it once again.
+struct CoalescedSteps {
+  QList<entt::entity> steps;
+};
+
+struct RepeatUntilFail {};
+
+// Execution, that has been cancelled. Its process might not be running at the
+// moment (e.g. between the build and the run of a target), so the execution
+// doesn't start any more processes.
+struct CancelledExecution {};
+
+// Build, that is being run by an execution, and steps of it, that have been
+// read from its .ninja_log so far. Once the build finishes, the log gets read
+// one last time to pick up the steps, that have finished last.
+struct RunningBuild {
+  QString build_folder;
+  QString log_path;
+  qint64 log_offset = 0;
+  QList<NinjaLogEntry> steps;
+  QDateTime start_time;
+  bool reading_log = false;
+  bool finished = false;
+};
+
+// Number of the slowest steps of a build, that get reported once it finishes.
+static constexpr int kSlowestBuildStepCount = 10;
+// Number of the most expensive entries of each category of a time trace
+// report.
+static constexpr int kTimeTraceEntryCount = 100;
+// Number of call sites, that allocated the most, which are kept in an
+// allocation profile.
+static constexpr int kAllocationSiteCount = 100;
+
+// Trace of a configure, that has been run with profiling, which is written
+// into the build folder.
+static constexpr const char* kCmakeTraceFileName = "cdt-cmake-profile.json";
+
+// Time, during which each target of a batch build was being built, in
+// milliseconds since the start of its execution.
+struct BatchBuildTimes {
+  struct Time {
+    qint64 GetDuration() const { return end - start; }
+
+    qint64 start = -1;
+    qint64 end = -1;
+  };
+
+  QStringList targets;
+  QList<Time> times;
+};
+
+// Execution, that keeps running several copies of an executable at the same
+// time until one of them fails. Each copy is run by its own worker entity,
+// which has an execution of its own, that is not displayed anywhere.
+struct StressRun {
+  QSharedPointer<QPromise<int>> promise;
+  QList<entt::entity> workers;
+  QDateTime start_time;
+  QDateTime last_report_time;
+  int iterations = 0;
+  bool stopping = false;
+  std::optional<int> failed_exit_code;
+  TextBuffer failed_output;
+  IntervalSet failed_stderr_line_indices;
+};
+
+struct StressWorker {
+  entt::entity run;
+};
+
+// Execution of a test executable, that is split into shards, each of which is
+// run by its own worker entity at the same time. Output of the execution
+// starts with a "[shards <count>] " line. Complete lines of output of each
+// shard get prefixed with "[shard <index>/<count>] " and forwarded to the
+// execution, so that they don't get mixed up.
+struct ShardedRun {
+  QSharedPointer<QPromise<int>> promise;
+  QList<entt::entity> workers;
+  QStringList args;
+  // Batches of QtTest functions, each of which is passed to the next worker,
+  // that runs out of work.
+  QList<QStringList> batches;
+  int exit_code = 0;
+};
+
+struct ShardWorker {
+  entt::entity run;
+  QString prefix;
+  QString stdout_line;
+  QString stderr_line;
+};
+
+// Last samples of resources, used by each process tree of an execution, by
+// PID of its root. Processes of an execution can run one after another (e.g.
+// build and then run) or at the same time (e.g. shards of a test).
+struct ResourceSamples {
+  QHash<qint64, ResourceUsage> trees;
+  ResourceUsage finished_trees;
+  QDateTime last_sample_time;
+  qint64 last_cpu_time = 0;
+};
+
+// Usage of children of the app, that have been reaped before the process of
+// an entity has started.
+struct ReapedChildrenUsage {
+  ResourceUsage usage;
+  qint64 pid = 0;
+  int finished_process_count = 0;
+};
+
+#if __linux__
+// Pseudo-terminal, that a process writes its stdout to. Standard C library
+// only line-buffers stdout when it is a terminal, so processes, that write to
+// a pipe, deliver their output in big delayed bursts and lose whatever is
+// left in the buffer when they crash.
+struct PtyOutput {
+  PtyOutput() = default;
+  PtyOutput(const PtyOutput&) = delete;
+  ~PtyOutput() {
+    delete notifier;
+    CloseSlave();
+    if (master >= 0) {
+      close(master);
+    }
+  }
+
+  // Once the process is started, only it should have the slave side of the
+  // terminal open, so that reading from the master side fails when the
+  // process exits.
+  void CloseSlave() {
+    if (slave >= 0) {
+      close(slave);
+      slave = -1;
+    }
+  }
+
+  int master = -1;
+  int slave = -1;
+  QSocketNotifier* notifier = nullptr;
+};
+#endif
+
 bool TaskExecution::IsNull() const { return id.isNull(); }
 
 UiIcon TaskExecution::GetStatusAsIcon() const {
@@ -44,11 +256,19 @@ TaskContext TaskSystem::ReadContextFromSql(QSqlQuery& sql) {
   TaskContext context;
   context.history_limit = sql.value(0).toInt();
   context.run_with_console_on_win = sql.value(1).toBool();
+  context.output_refresh_interval = sql.value(2).toInt();
+  context.output_spill_threshold = sql.value(3).toInt();
+  context.run_in_pty = sql.value(4).toBool();
+  context.output_head_limit = sql.value(5).toInt();
+  context.output_tail_limit = sql.value(6).toInt();
+  context.job_limit = sql.value(7).toInt();
+  context.slow_build_step_threshold = sql.value(8).toInt();
   return context;
 }
 
 void TaskSystem::KillAllTasks() {
   LOG() << "Killing all tasks";
+  stopWatchingTask();
   QList<entt::entity> to_destroy;
   for (auto [entity, proc] : registry.view<QProcess>().each()) {
     proc.kill();
@@ -67,12 +287,44 @@ static std::function<TaskExecution(QSqlQuery&)> MakeReadExecutionFromSql(
     exec.task_name = query.value(3).toString();
     exec.task_data = query.value(4).toByteArray();
     exec.exit_code = query.value(5).toInt();
+    exec.resource_usage =
+        ResourceUsage::Deserialize(query.value(6).toByteArray());
+    QByteArray perf_counters = query.value(7).toByteArray();
+    if (!perf_counters.isEmpty()) {
+      exec.perf_counters = PerfCounters::Deserialize(perf_counters);
+    }
     if (include_output) {
-      QString indices = query.value(6).toString();
-      for (const QString& i : indices.split(',', Qt::SkipEmptyParts)) {
-        exec.stderr_line_indices.insert(i.toInt());
+      QByteArray stderr_lines = query.value(12).toByteArray();
+      if (!stderr_lines.isEmpty()) {
+        exec.stderr_line_indices = IntervalSet::Deserialize(stderr_lines);
+      } else {
+        // Older versions of the app stored indices as a comma-separated list.
+        QString indices = query.value(8).toString();
+        for (const QString& i : indices.split(',', Qt::SkipEmptyParts)) {
+          exec.stderr_line_indices.Insert(i.toInt());
+        }
+      }
+      exec.elided_size = query.value(13).toLongLong();
+      exec.elided_line_count = query.value(14).toLongLong();
+      exec.line_times = LineTimes::Deserialize(query.value(15).toByteArray());
+      QString output_file = query.value(10).toString();
+      QByteArray line_index = query.value(11).toByteArray();
+      if (!output_file.isEmpty()) {
+        exec.output = TextBuffer::ReadSpillFile(output_file, line_index);
+      } else if (!line_index.isEmpty()) {
+        auto pieces = Database::ExecQueryAndRead<std::pair<QByteArray, int>>(
+            "SELECT c.data, r.length FROM task_execution_output_chunk r "
+            "JOIN task_output_chunk c ON r.hash = c.hash "
+            "WHERE r.execution_id = ? ORDER BY r.chunk_index",
+            [](QSqlQuery& sql) {
+              return std::make_pair(sql.value(0).toByteArray(),
+                                    sql.value(1).toInt());
+            },
+            {exec.id});
+        exec.output = TextBuffer::Decompress(line_index, pieces);
+      } else {
+        exec.output.Append(query.value(9).toString());
       }
-      exec.output = query.value(7).toString();
     }
     return exec;
   };
@@ -84,8 +336,9 @@ void TaskSystem::LoadLastTaskExecution() {
       this,
       [id] {
         return Database::ExecQueryAndRead(
-            "SELECT id, start_time, task_id, task_name, task_data, exit_code "
-            "FROM task_execution WHERE project_id = ? ORDER BY start_time DESC",
+            "SELECT id, start_time, task_id, task_name, task_data, exit_code, "
+            "resource_usage, perf_counters FROM task_execution "
+            "WHERE project_id = ? ORDER BY start_time DESC",
             MakeReadExecutionFromSql(false), {id});
       },
       [this](QList<TaskExecution> execs) {
@@ -105,35 +358,274 @@ void TaskSystem::ClearLastTaskExecution() {
   emit currentTaskChanged();
 }
 
-void TaskSystem::AppendToExecutionOutput(entt::entity entity, bool is_stderr) {
-  if (!registry.all_of<QProcess>(entity)) {
+void TaskSystem::ReadProcessOutput(entt::entity entity, bool is_stderr) {
+  if (!registry.all_of<QProcess, PendingOutput>(entity)) {
     return;
   }
   auto& proc = registry.get<QProcess>(entity);
+  auto& pending = registry.get<PendingOutput>(entity);
+  // Decoders keep multi-byte characters, that got split between two reads,
+  // intact.
   QString data;
   if (is_stderr) {
-    data = proc.readAllStandardError();
+    data = pending.stderr_decoder(proc.readAllStandardError());
   } else {
-    data = proc.readAllStandardOutput();
+    data = pending.stdout_decoder(proc.readAllStandardOutput());
   }
   AppendToExecutionOutput(entity, data, is_stderr);
 }
 
-void TaskSystem::AppendToExecutionOutput(entt::entity entity, QString data,
-                                         bool is_stderr) {
-  if (!registry.all_of<TaskExecution>(entity)) {
+void TaskSystem::AppendToExecutionOutput(entt::entity entity,
+                                         const QString& data, bool is_stderr) {
+  if (data.isEmpty() || !registry.all_of<PendingOutput>(entity)) {
+    return;
+  }
+  if (registry.all_of<ShardWorker>(entity)) {
+    ForwardShardOutput(entity, data, is_stderr, false);
+    return;
+  }
+  auto& pending = registry.get<PendingOutput>(entity);
+  if (!pending.clock.isValid()) {
+    pending.clock.start();
+  }
+  auto time = static_cast<quint32>(pending.clock.elapsed());
+  for (int i = data.count('\n'); i > 0; i--) {
+    pending.line_end_times.append(time);
+  }
+  pending.last_piece_time = time;
+  if (!pending.pieces.isEmpty() &&
+      pending.pieces.constLast().second == is_stderr) {
+    pending.pieces.last().first += data;
+  } else {
+    pending.pieces.append(std::make_pair(data, is_stderr));
+  }
+  if (!pending.publish_scheduled) {
+    pending.publish_scheduled = true;
+    QTimer::singleShot(context.output_refresh_interval, this,
+                       [this, entity] { PublishExecutionOutput(entity); });
+  }
+}
+
+#if __linux__
+void TaskSystem::OpenPty(entt::entity entity) {
+  auto& p = registry.get<QProcess>(entity);
+  auto& pty = registry.emplace_or_replace<PtyOutput>(entity);
+  pty.master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+  char slave_name[128];
+  if (pty.master < 0 || grantpt(pty.master) != 0 ||
+      unlockpt(pty.master) != 0 ||
+      ptsname_r(pty.master, slave_name, sizeof(slave_name)) != 0 ||
+      fcntl(pty.master, F_SETFL, O_NONBLOCK) != 0) {
+    LOG() << "Failed to open pseudo-terminal:" << strerror(errno);
+    // A modifier, that has been left by a previous run of the process,
+    // would redirect its output to a terminal, that has been closed since.
+    p.setChildProcessModifier({});
+    registry.remove<PtyOutput>(entity);
+    return;
+  }
+  pty.slave = open(slave_name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+  if (pty.slave < 0) {
+    LOG() << "Failed to open pseudo-terminal" << slave_name << ":"
+          << strerror(errno);
+    p.setChildProcessModifier({});
+    registry.remove<PtyOutput>(entity);
+    return;
+  }
+  // Don't let the terminal turn "\n" into "\r\n".
+  termios attrs;
+  if (tcgetattr(pty.slave, &attrs) == 0) {
+    attrs.c_oflag &= ~OPOST;
+    tcsetattr(pty.slave, TCSANOW, &attrs);
+  }
+  // stderr stays a pipe, which keeps it distinguishable from stdout. It is
+  // not buffered anyway.
+  int slave = pty.slave;
+  p.setChildProcessModifier([slave] { dup2(slave, STDOUT_FILENO); });
+  // Processes, that are aware of terminals, should not decorate their output
+  // with escape sequences or redraw it in place.
+  QProcessEnvironment env = p.processEnvironment();
+  if (env.isEmpty()) {
+    env = QProcessEnvironment::systemEnvironment();
+  }
+  env.insert("TERM", "dumb");
+  p.setProcessEnvironment(env);
+  pty.notifier = new QSocketNotifier(pty.master, QSocketNotifier::Read);
+  connect(pty.notifier, &QSocketNotifier::activated, this,
+          [this, entity] { ReadPtyOutput(entity); });
+}
+
+void TaskSystem::ReadPtyOutput(entt::entity entity) {
+  if (!registry.all_of<PtyOutput, PendingOutput>(entity)) {
+    return;
+  }
+  auto& pty = registry.get<PtyOutput>(entity);
+  QByteArray data;
+  char buffer[64 * 1024];
+  while (true) {
+    ssize_t count = read(pty.master, buffer, sizeof(buffer));
+    if (count > 0) {
+      data.append(buffer, count);
+      continue;
+    }
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count == 0 || errno != EAGAIN) {
+      // All the processes, that had the terminal open, have exited.
+      pty.notifier->setEnabled(false);
+    }
+    break;
+  }
+  auto& pending = registry.get<PendingOutput>(entity);
+  AppendToExecutionOutput(entity, pending.stdout_decoder(data), false);
+}
+#endif
+
+void TaskSystem::PublishExecutionOutput(entt::entity entity) {
+  if (!registry.all_of<TaskExecution, PendingOutput>(entity)) {
     return;
   }
   auto& exec = registry.get<TaskExecution>(entity);
-  data.remove('\r');
-  if (is_stderr) {
-    int lines_before = exec.output.count('\n');
-    for (int i = 0; i < data.count('\n'); i++) {
-      exec.stderr_line_indices.insert(i + lines_before);
+  auto& pending = registry.get<PendingOutput>(entity);
+  pending.publish_scheduled = false;
+  if (pending.pieces.isEmpty()) {
+    return;
+  }
+  int start_offset = exec.output.GetSize();
+  int first_new_line = std::max(exec.output.GetLineCount() - 1, 0);
+  QList<std::pair<int, int>> stderr_ranges;
+  for (const auto& [piece, is_stderr] : pending.pieces) {
+    if (is_stderr) {
+      int lines_before = std::max(exec.output.GetLineCount() - 1, 0);
+      int new_lines = piece.count('\n');
+      exec.stderr_line_indices.Insert(lines_before,
+                                      lines_before + new_lines - 1);
+      if (new_lines > 0) {
+        stderr_ranges.append(
+            std::make_pair(lines_before, lines_before + new_lines - 1));
+      }
+    }
+    // Progress bars redraw their line after "\r", which overwrites the last
+    // line of the output instead of adding new ones.
+    start_offset = std::min(start_offset, exec.output.Write(piece));
+  }
+  pending.pieces.clear();
+  // Lines, that have ended, arrived along with their "\n", while the last
+  // line, that is still being printed, arrived with the last piece.
+  int last_line = exec.output.GetLineCount() - 1;
+  for (int i = first_new_line; i < last_line; i++) {
+    int j = i - first_new_line;
+    exec.line_times.Set(i, j < pending.line_end_times.size()
+                               ? pending.line_end_times[j]
+                               : pending.last_piece_time);
+  }
+  if (exec.output.GetLineLength(last_line) > 0) {
+    exec.line_times.Set(last_line, pending.last_piece_time);
+  } else {
+    exec.line_times.Truncate(last_line);
+  }
+  pending.line_end_times.clear();
+  if (auto build = registry.try_get<RunningBuild>(entity);
+      build && !build->finished) {
+    TrackBuildProgress(entity, first_new_line, last_line);
+  }
+  if (registry.all_of<BatchBuildTimes>(entity)) {
+    TrackBatchBuildTargets(entity, first_new_line, last_line);
+  }
+  if (int elided_offset = ElideExecutionOutput(entity); elided_offset >= 0) {
+    start_offset = std::min(start_offset, elided_offset);
+  }
+  QString data = exec.output.GetText(start_offset, exec.output.GetSize());
+  if (!data.isEmpty()) {
+    int first_line = exec.output.GetLineWithOffset(start_offset);
+    emit executionOutputAppended(exec.id, start_offset, data, stderr_ranges,
+                                 exec.line_times.Mid(first_line));
+  }
+}
+
+int TaskSystem::ElideExecutionOutput(entt::entity entity) {
+  // Limits are specified in megabytes while the buffer counts UTF-16
+  // characters. Output, that is not limited, still gets elided before it
+  // outgrows the buffer.
+  static const qint64 kMaxLimit = TextBuffer::kMaxSize / 4;
+  OutputLimits limits{context.output_head_limit, context.output_tail_limit};
+  if (auto own_limits = registry.try_get<OutputLimits>(entity)) {
+    limits = *own_limits;
+  }
+  qint64 head_limit = limits.head * 1024LL * 1024 / 2;
+  qint64 tail_limit = limits.tail * 1024LL * 1024 / 2;
+  if (head_limit <= 0 && tail_limit <= 0) {
+    head_limit = kMaxLimit;
+    tail_limit = kMaxLimit;
+  }
+  head_limit = std::clamp(head_limit, 0LL, kMaxLimit);
+  tail_limit = std::clamp(tail_limit, 0LL, kMaxLimit);
+  auto& exec = registry.get<TaskExecution>(entity);
+  const TextBuffer& output = exec.output;
+  auto* elided = registry.try_get<ElidedOutput>(entity);
+  if (!elided) {
+    if (output.GetSize() <= head_limit + 2 * tail_limit) {
+      return -1;
     }
+    // Only keep complete lines in the head.
+    elided = &registry.emplace<ElidedOutput>(entity);
+    elided->head_line_count =
+        output.GetLineWithOffset(static_cast<int>(head_limit));
+    elided->head_size = output.GetLineOffset(elided->head_line_count);
+    elided->tail_offset = elided->head_size;
+    elided->tail_line = elided->head_line_count;
+  }
+  // The tail is allowed to grow twice as big as its limit, so that the output
+  // gets rebuilt once in a while instead of on every update.
+  if (output.GetSize() <= elided->tail_offset + 2 * tail_limit) {
+    return -1;
   }
-  exec.output += data;
-  emit executionOutputChanged(exec.id);
+  int tail_start = output.GetSize() - static_cast<int>(tail_limit);
+  int tail_line = output.GetLineWithOffset(tail_start);
+  if (output.GetLineOffset(tail_line) < tail_start &&
+      tail_line + 1 < output.GetLineCount()) {
+    tail_line++;
+    tail_start = output.GetLineOffset(tail_line);
+  }
+  exec.elided_size += tail_start - elided->tail_offset;
+  exec.elided_line_count += tail_line - elided->tail_line;
+  QString marker = QString("[... %1 lines (%2 characters) elided ...]\n")
+                       .arg(exec.elided_line_count)
+                       .arg(exec.elided_size);
+  // The last line is written instead of appended, since it might not be
+  // complete yet.
+  int last_line_offset =
+      std::max(output.GetLineOffset(output.GetLineCount() - 1), tail_start);
+  TextBuffer trimmed = output;
+  trimmed.Clear();
+  auto append = [&trimmed, &output](int start, int end) {
+    for (int i = start; i < end; i += TextBuffer::kChunkSize) {
+      trimmed.Append(
+          output.GetText(i, std::min(TextBuffer::kChunkSize, end - i)));
+    }
+  };
+  append(0, elided->head_size);
+  trimmed.Append(marker);
+  append(tail_start, last_line_offset);
+  trimmed.Write(output.GetText(last_line_offset,
+                               output.GetSize() - last_line_offset));
+  // Lines, that were printed to stderr, have moved along with the tail.
+  int line_shift = tail_line - elided->head_line_count - 1;
+  IntervalSet stderr_line_indices;
+  for (auto [first, last] : exec.stderr_line_indices.GetIntervals()) {
+    stderr_line_indices.Insert(
+        first, std::min(last, elided->head_line_count - 1));
+    stderr_line_indices.Insert(std::max(first, tail_line) - line_shift,
+                               last - line_shift);
+  }
+  LOG() << "Elided" << tail_start - elided->tail_offset
+        << "characters of output of execution" << exec.id;
+  exec.output = trimmed;
+  exec.stderr_line_indices = stderr_line_indices;
+  exec.line_times.Collapse(elided->head_line_count, tail_line);
+  elided->tail_offset = elided->head_size + marker.size();
+  elided->tail_line = elided->head_line_count + 1;
+  return elided->head_size;
 }
 
 void TaskSystem::FinishExecution(entt::entity entity, int exit_code) {
@@ -142,26 +634,212 @@ void TaskSystem::FinishExecution(entt::entity entity, int exit_code) {
   }
   auto exec = registry.get<TaskExecution>(entity);
   exec.exit_code = exit_code;
+  exec.resource_usage.ClearLiveValues();
   LOG() << "Task execution" << exec.id << "finished with code" << exit_code;
   const Project& project = Application::Get().project.GetCurrentProject();
-  QStringList indices;
-  for (int i : std::as_const(exec.stderr_line_indices)) {
-    indices.append(QString::number(i));
-  }
-  QList<Database::Cmd> cmds;
-  cmds.append(Database::Cmd(
-      "INSERT INTO task_execution VALUES(?,?,?,?,?,?,?,?,?)",
-      {exec.id, project.id, exec.start_time, exec.task_id, exec.task_name,
-       exec.task_data, *exec.exit_code, indices.join(','), exec.output}));
-  if (context.history_limit > 0) {
-    cmds.append(
-        Database::Cmd("DELETE FROM task_execution WHERE id NOT IN (SELECT id "
-                      "FROM task_execution ORDER BY start_time DESC LIMIT ?)",
-                      {context.history_limit}));
-  }
-  Database::ExecCmdsAsync(cmds);
+  QVariantList args = {exec.id,         project.id,     exec.start_time,
+                       exec.task_id,    exec.task_name, exec.task_data,
+                       *exec.exit_code, QVariant()};
+  // Output, that got spilled to disk, stays there and the database only
+  // references the file and its line index. Otherwise it gets compressed,
+  // which is done on the IO thread since the output can be quite large.
+  QString output_file = exec.output.PersistSpillFile();
+  TextBuffer output = exec.output;
+  QUuid id = exec.id;
+  QByteArray stderr_lines = exec.stderr_line_indices.Serialize();
+  qint64 elided_size = exec.elided_size;
+  qint64 elided_line_count = exec.elided_line_count;
+  QByteArray resource_usage = exec.resource_usage.Serialize();
+  QByteArray line_times = exec.line_times.Serialize();
+  QVariant time_trace_report, cmake_profile, cpu_profile, perf_counters,
+      allocation_profile;
+  if (!exec.time_trace_report.IsNull()) {
+    time_trace_report = exec.time_trace_report.Serialize();
+  }
+  if (!exec.cmake_profile.IsNull()) {
+    cmake_profile = exec.cmake_profile.Serialize();
+  }
+  if (!exec.cpu_profile.IsNull()) {
+    cpu_profile = exec.cpu_profile.Serialize();
+  }
+  if (!exec.perf_counters.IsNull()) {
+    perf_counters = exec.perf_counters.Serialize();
+  }
+  if (!exec.allocation_profile.IsNull()) {
+    allocation_profile = exec.allocation_profile.Serialize();
+  }
+  int history_limit = context.history_limit;
+  IoTask::Run([args, id, output, output_file, stderr_lines, elided_size,
+               elided_line_count, resource_usage, line_times,
+               time_trace_report, cmake_profile, cpu_profile, perf_counters,
+               allocation_profile, history_limit]() mutable {
+    if (output_file.isEmpty()) {
+      args << QVariant() << QVariant() << output.CompressLineIndex();
+    } else {
+      // Saves scanning the whole file for lines, when it is read back.
+      args << QVariant() << output_file << output.CompressLineIndex();
+    }
+    args << stderr_lines << elided_size << elided_line_count << resource_usage
+         << line_times << time_trace_report << cmake_profile << cpu_profile
+         << perf_counters << allocation_profile;
+    Database::Transaction t;
+    Database::ExecCmd(
+        "INSERT INTO task_execution "
+        "VALUES(?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)",
+        args);
+    if (output_file.isEmpty()) {
+      WriteOutputPiecesSync(id, output);
+    }
+    if (history_limit > 0) {
+      RemoveExecutionsSync(
+          "id NOT IN (SELECT id FROM task_execution ORDER BY start_time DESC "
+          "LIMIT ?)",
+          {history_limit});
+    }
+  });
+  QList<entt::entity> steps;
+  if (auto coalesced = registry.try_get<CoalescedSteps>(entity)) {
+    steps = coalesced->steps;
+  }
+  if (registry.all_of<PipelineStep>(entity)) {
+    FinishPipelineStep(entity, exit_code);
+  }
+  for (entt::entity step : steps) {
+    FinishPipelineStep(step, exit_code);
+  }
+  registry.destroy(steps.begin(), steps.end());
   registry.destroy(entity);
   emit executionFinished(exec.id);
+  ScheduleTasks();
+  if (watched_task && watched_task->run == entity) {
+    watched_task->run = entt::null;
+    if (watched_task->rerun_pending) {
+      RerunWatchedTask();
+    }
+  }
+}
+
+void TaskSystem::SampleResourceUsage() {
+  QList<std::pair<entt::entity, qint64>> processes;
+  for (auto [entity, proc] : registry.view<const QProcess>().each()) {
+    if (proc.state() == QProcess::Running) {
+      processes.append(std::make_pair(entity, proc.processId()));
+    }
+  }
+  if (processes.isEmpty() && registry.view<ResourceSamples>().empty()) {
+    return;
+  }
+  IoTask::Run<QList<ResourceUsage>>(
+      this,
+      [processes] {
+        QList<ResourceUsage> usages;
+        for (auto [_, pid] : processes) {
+          usages.append(ResourceUsage::SampleProcessTreeSync(pid));
+        }
+        return usages;
+      },
+      [this, processes](QList<ResourceUsage> usages) {
+        UpdateResourceUsage(processes, usages);
+      });
+}
+
+void TaskSystem::UpdateResourceUsage(
+    const QList<std::pair<entt::entity, qint64>>& processes,
+    const QList<ResourceUsage>& usages) {
+  std::unordered_map<entt::entity, QHash<qint64, ResourceUsage>> trees;
+  for (int i = 0; i < processes.size(); i++) {
+    auto [entity, pid] = processes[i];
+    // Final usage of a process, that has finished while being sampled, has
+    // already been accounted for.
+    if (!registry.valid(entity) || !registry.all_of<QProcess>(entity) ||
+        registry.get<QProcess>(entity).processId() != pid) {
+      continue;
+    }
+    entt::entity owner = GetResourceUsageOwner(entity);
+    if (owner == entt::null) {
+      continue;
+    }
+    registry.get_or_emplace<ResourceSamples>(owner);
+    trees[owner][pid] = usages[i];
+  }
+  QDateTime now = QDateTime::currentDateTime();
+  for (auto [entity, exec, samples] :
+       registry.view<TaskExecution, ResourceSamples>().each()) {
+    const QHash<qint64, ResourceUsage>& running = trees[entity];
+    // Process trees, that are no longer running, have been sampled for the
+    // last time.
+    for (auto it = samples.trees.cbegin(); it != samples.trees.cend(); it++) {
+      if (!running.contains(it.key())) {
+        samples.finished_trees.Add(it.value());
+      }
+    }
+    samples.trees = running;
+    ResourceUsage usage = samples.finished_trees;
+    usage.ClearLiveValues();
+    for (const ResourceUsage& tree : running) {
+      usage.Add(tree);
+    }
+    qint64 ms = samples.last_sample_time.msecsTo(now);
+    if (samples.last_sample_time.isValid() && ms > 0) {
+      usage.cpu_percent = std::max(
+          0.0, 100.0 * (usage.GetCpuTime() - samples.last_cpu_time) / ms);
+    }
+    samples.last_sample_time = now;
+    samples.last_cpu_time = usage.GetCpuTime();
+    usage.peak_rss = std::max(
+        {usage.peak_rss, usage.rss, exec.resource_usage.peak_rss});
+    exec.resource_usage = usage;
+    emit executionResourceUsageChanged(exec.id);
+  }
+}
+
+void TaskSystem::FinishResourceUsage(entt::entity entity) {
+  auto reaped = registry.try_get<ReapedChildrenUsage>(entity);
+  bool is_only_reaped = reaped && reaped->finished_process_count ==
+                                      finished_process_count;
+  finished_process_count++;
+  if (!reaped) {
+    return;
+  }
+  qint64 pid = reaped->pid;
+  ResourceUsage usage =
+      ResourceUsage::GetReapedChildrenUsage().GetReapedChildrenUsageSince(
+          reaped->usage);
+  registry.remove<ReapedChildrenUsage>(entity);
+  entt::entity owner = GetResourceUsageOwner(entity);
+  if (owner == entt::null) {
+    return;
+  }
+  // The last sample of the process tree might be up to a second old.
+  auto& samples = registry.get_or_emplace<ResourceSamples>(owner);
+  ResourceUsage tree = samples.trees.take(pid);
+  if (is_only_reaped) {
+    tree.Merge(usage);
+  }
+  samples.finished_trees.Add(tree);
+  auto& exec = registry.get<TaskExecution>(owner);
+  ResourceUsage total = samples.finished_trees;
+  total.ClearLiveValues();
+  for (const ResourceUsage& running : samples.trees) {
+    total.Add(running);
+  }
+  total.peak_rss = std::max(total.peak_rss, exec.resource_usage.peak_rss);
+  exec.resource_usage = total;
+  emit executionResourceUsageChanged(exec.id);
+}
+
+entt::entity TaskSystem::GetResourceUsageOwner(entt::entity entity) const {
+  // Workers of stress and sharded runs are accounted for in their runs.
+  entt::entity owner = entity;
+  if (auto worker = registry.try_get<StressWorker>(entity)) {
+    owner = worker->run;
+  } else if (auto worker = registry.try_get<ShardWorker>(entity)) {
+    owner = worker->run;
+  }
+  if (!registry.valid(owner) || !registry.all_of<TaskExecution>(owner)) {
+    return entt::null;
+  }
+  return owner;
 }
 
 const TaskExecution* TaskSystem::FindExecutionById(QUuid id) const {
@@ -177,7 +855,8 @@ Promise<QList<TaskExecution>> TaskSystem::FetchExecutions(
     QUuid project_id) const {
   LOG() << "Fetching executions for project" << project_id;
   QList<TaskExecution> execs;
-  for (auto [_, exec] : registry.view<const TaskExecution>().each()) {
+  for (auto [_, exec] :
+       registry.view<const TaskExecution>(entt::exclude<StressWorker>).each()) {
     execs.append(exec);
   }
   std::sort(execs.begin(), execs.end(),
@@ -186,8 +865,8 @@ Promise<QList<TaskExecution>> TaskSystem::FetchExecutions(
             });
   return IoTask::Run<QList<TaskExecution>>([project_id, execs] {
     QList<TaskExecution> result = Database::ExecQueryAndRead<TaskExecution>(
-        "SELECT id, start_time, task_id, task_name, task_data, exit_code FROM "
-        "task_execution "
+        "SELECT id, start_time, task_id, task_name, task_data, exit_code, "
+        "resource_usage, perf_counters FROM task_execution "
         "WHERE project_id=? ORDER BY start_time",
         MakeReadExecutionFromSql(false), {project_id});
     for (const TaskExecution& exec : execs) {
@@ -211,9 +890,12 @@ Promise<TaskExecution> TaskSystem::FetchExecution(QUuid execution_id,
   }
   return IoTask::Run<TaskExecution>([execution_id, include_output] {
     QString query =
-        "SELECT id, start_time, task_id, task_name, task_data, exit_code";
+        "SELECT id, start_time, task_id, task_name, task_data, exit_code, "
+        "resource_usage, perf_counters";
     if (include_output) {
-      query += ", stderr_line_indices, output";
+      query +=
+          ", stderr_line_indices, output, output_file, output_line_index, "
+          "stderr_lines, elided_size, elided_line_count, line_times";
     }
     query += " FROM task_execution WHERE id=?";
     QList<TaskExecution> results = Database::ExecQueryAndRead<TaskExecution>(
@@ -222,44 +904,192 @@ Promise<TaskExecution> TaskSystem::FetchExecution(QUuid execution_id,
   });
 }
 
+Promise<TimeTraceReport> TaskSystem::FetchTimeTraceReport(
+    QUuid execution_id) const {
+  LOG() << "Fetching time trace report of execution" << execution_id;
+  if (const TaskExecution* exec = FindExecutionById(execution_id)) {
+    return Promise<TimeTraceReport>(exec->time_trace_report);
+  }
+  return IoTask::Run<TimeTraceReport>([execution_id] {
+    QList<QByteArray> results = Database::ExecQueryAndRead<QByteArray>(
+        "SELECT time_trace_report FROM task_execution WHERE id=?",
+        [](QSqlQuery& sql) { return sql.value(0).toByteArray(); },
+        {execution_id});
+    if (results.isEmpty() || results[0].isEmpty()) {
+      return TimeTraceReport();
+    }
+    return TimeTraceReport::Deserialize(results[0]);
+  });
+}
+
+Promise<CmakeProfile> TaskSystem::FetchCmakeProfile(QUuid execution_id) const {
+  LOG() << "Fetching CMake profile of execution" << execution_id;
+  if (const TaskExecution* exec = FindExecutionById(execution_id)) {
+    return Promise<CmakeProfile>(exec->cmake_profile);
+  }
+  return IoTask::Run<CmakeProfile>([execution_id] {
+    QList<QByteArray> results = Database::ExecQueryAndRead<QByteArray>(
+        "SELECT cmake_profile FROM task_execution WHERE id=?",
+        [](QSqlQuery& sql) { return sql.value(0).toByteArray(); },
+        {execution_id});
+    if (results.isEmpty() || results[0].isEmpty()) {
+      return CmakeProfile();
+    }
+    return CmakeProfile::Deserialize(results[0]);
+  });
+}
+
+Promise<CpuProfile> TaskSystem::FetchCpuProfile(QUuid execution_id) const {
+  LOG() << "Fetching CPU profile of execution" << execution_id;
+  if (const TaskExecution* exec = FindExecutionById(execution_id)) {
+    return Promise<CpuProfile>(exec->cpu_profile);
+  }
+  return IoTask::Run<CpuProfile>([execution_id] {
+    QList<QByteArray> results = Database::ExecQueryAndRead<QByteArray>(
+        "SELECT cpu_profile FROM task_execution WHERE id=?",
+        [](QSqlQuery& sql) { return sql.value(0).toByteArray(); },
+        {execution_id});
+    if (results.isEmpty() || results[0].isEmpty()) {
+      return CpuProfile();
+    }
+    return CpuProfile::Deserialize(results[0]);
+  });
+}
+
+Promise<AllocationProfile> TaskSystem::FetchAllocationProfile(
+    QUuid execution_id) const {
+  LOG() << "Fetching allocation profile of execution" << execution_id;
+  if (const TaskExecution* exec = FindExecutionById(execution_id)) {
+    return Promise<AllocationProfile>(exec->allocation_profile);
+  }
+  return IoTask::Run<AllocationProfile>([execution_id] {
+    QList<QByteArray> results = Database::ExecQueryAndRead<QByteArray>(
+        "SELECT allocation_profile FROM task_execution WHERE id=?",
+        [](QSqlQuery& sql) { return sql.value(0).toByteArray(); },
+        {execution_id});
+    if (results.isEmpty() || results[0].isEmpty()) {
+      return AllocationProfile();
+    }
+    return AllocationProfile::Deserialize(results[0]);
+  });
+}
+
 QList<TaskExecution> TaskSystem::GetActiveExecutions() const {
   QList<TaskExecution> execs;
-  for (auto [_, exec] : registry.view<const TaskExecution>().each()) {
+  for (auto [_, exec] :
+       registry.view<const TaskExecution>(entt::exclude<StressWorker>).each()) {
     execs.append(exec);
   }
   return execs;
 }
 
 void TaskSystem::cancelSelectedExecution(bool forcefully) {
-  for (auto [_, exec, proc] :
-       registry.view<const TaskExecution, QProcess>().each()) {
-    if (exec.id != selected_execution_id) {
-      continue;
+  for (auto [entity, exec] : registry.view<const TaskExecution>().each()) {
+    if (exec.id == selected_execution_id) {
+      CancelExecution(entity, forcefully);
     }
-    LOG() << "Attempting to cancel execution" << selected_execution_id
-          << "forcefully:" << forcefully;
+  }
+}
+
+void TaskSystem::CancelExecution(entt::entity e, bool forcefully) {
+  LOG() << "Attempting to cancel execution"
+        << registry.get<TaskExecution>(e).id << "forcefully:" << forcefully;
+  registry.emplace_or_replace<CancelledExecution>(e);
+  if (registry.all_of<StressRun>(e)) {
+    StopStressRun(e);
+  }
+  if (registry.all_of<ShardedRun>(e)) {
+    StopShardedRun(e);
+  }
+  if (auto proc = registry.try_get<QProcess>(e)) {
     if (forcefully) {
-      proc.kill();
+      proc->kill();
     } else {
-      proc.terminate();
+      proc->terminate();
+    }
+  }
+}
+
+void TaskSystem::stopWatchingTask() {
+  if (!watched_task) {
+    return;
+  }
+  LOG() << "No longer re-running" << watched_task->task_id << "on changes";
+  file_watcher.Stop();
+  watched_task.reset();
+}
+
+void TaskSystem::WatchTask(entt::entity e, const QString& view) {
+  stopWatchingTask();
+  RunExecution(e, false, view);
+  const auto& exec = registry.get<TaskExecution>(e);
+  LOG() << "Re-running" << exec.task_id << "on changes";
+  WatchedTask watched;
+  watched.task_id = exec.task_id;
+  watched.task_data = exec.task_data;
+  watched.run = e;
+  watched.execution_id = exec.id;
+  watched_task = watched;
+  file_watcher.Watch(QDir::currentPath());
+  Application::Get().notification.Post(
+      Notification("Tasks: Re-running '" + exec.task_name + "' on changes"));
+}
+
+void TaskSystem::RerunWatchedTask() {
+  if (!watched_task) {
+    return;
+  }
+  WatchedTask& watched = *watched_task;
+  if (watched.run != entt::null) {
+    // Starting a new run while the outdated one is still in progress would
+    // make both of them compete over the same build folder, so the outdated
+    // run gets cancelled and the task gets re-run once it finishes.
+    if (!watched.rerun_pending) {
+      LOG() << "Cancelling outdated execution" << watched.execution_id;
+      watched.rerun_pending = true;
+      CancelExecution(watched.run, false);
     }
+    return;
+  }
+  watched.rerun_pending = false;
+  LOG() << "Files have changed, re-running" << watched.task_id;
+  entt::entity e = registry.create();
+  registry.emplace<TaskId>(e, watched.task_id);
+  EmplaceTask(registry, e, watched.task_id, watched.task_data);
+  RunExecution(e, false, "");
+  const auto& exec = registry.get<TaskExecution>(e);
+  last_execution = exec;
+  emit currentTaskChanged();
+  // Runs happen in background, unless the previous one is being looked at.
+  if (selected_execution_id == watched.execution_id) {
+    SetSelectedExecutionId(exec.id);
   }
+  watched.run = e;
+  watched.execution_id = exec.id;
 }
 
 void TaskSystem::RunExecution(entt::entity entity, bool repeat_until_fail,
-                              const QString& view) {
+                              const QString& view, ParallelMode parallel) {
   auto& task_id = registry.get<TaskId>(entity);
-  LOG() << "Executing" << task_id << "repeat until fail:" << repeat_until_fail;
+  LOG() << "Executing" << task_id << "repeat until fail:" << repeat_until_fail
+        << "parallel mode:" << static_cast<int>(parallel);
   auto& exec = registry.emplace<TaskExecution>(entity);
   exec.id = QUuid::createUuid();
   exec.start_time = QDateTime::currentDateTime();
   exec.task_id = task_id;
   exec.task_name = GetTaskName(registry, entity);
+  if (context.output_spill_threshold > 0) {
+    // Threshold is specified in megabytes while the buffer counts UTF-16
+    // characters.
+    int threshold = context.output_spill_threshold * 1024 * 1024 / 2;
+    exec.output.SetSpillFolder(GetOutputFolder(), threshold);
+  }
   if (registry.any_of<CmakeTask>(entity)) {
     const auto& t = registry.get<CmakeTask>(entity);
     QJsonObject o;
     o["source_path"] = t.source_path;
     o["build_path"] = t.build_path;
+    o["profile"] = t.profile;
     exec.task_data = QJsonDocument(o).toJson();
   } else if (registry.any_of<CmakeTargetTask>(entity)) {
     const auto& t = registry.get<CmakeTargetTask>(entity);
@@ -273,6 +1103,14 @@ void TaskSystem::RunExecution(entt::entity entity, bool repeat_until_fail,
     }
     o["executable_args"] = args;
     o["run_after_build"] = t.run_after_build;
+    o["profiler"] = static_cast<int>(t.profiler);
+    exec.task_data = QJsonDocument(o).toJson();
+  } else if (registry.any_of<CmakeBatchBuildTask>(entity)) {
+    const auto& t = registry.get<CmakeBatchBuildTask>(entity);
+    QJsonObject o;
+    o["build_folder"] = t.build_folder;
+    o["target_names"] = QJsonArray::fromStringList(t.target_names);
+    o["jobs"] = t.jobs;
     exec.task_data = QJsonDocument(o).toJson();
   } else if (registry.any_of<ExecutableTask>(entity)) {
     const auto& t = registry.get<ExecutableTask>(entity);
@@ -283,13 +1121,20 @@ void TaskSystem::RunExecution(entt::entity entity, bool repeat_until_fail,
       args.append(arg);
     }
     o["args"] = args;
+    o["profiler"] = static_cast<int>(t.profiler);
     exec.task_data = QJsonDocument(o).toJson();
   } else {
     qFatal() << "Failed to execute task" << task_id << "of unknown type";
   }
   registry.emplace<QProcess>(entity);
-  Promise<int> proc;
+  registry.emplace<PendingOutput>(entity);
   if (repeat_until_fail) {
+    registry.emplace<RepeatUntilFail>(entity);
+  }
+  Promise<int> proc;
+  if (parallel != ParallelMode::kNone) {
+    proc = RunTaskInParallel(entity, parallel);
+  } else if (repeat_until_fail) {
     proc = RunTaskUntilFail(entity);
   } else {
     proc = RunTask(entity);
@@ -297,12 +1142,222 @@ void TaskSystem::RunExecution(entt::entity entity, bool repeat_until_fail,
   proc.Then(this, [this, entity](int exit_code) {
     FinishExecution(entity, exit_code);
   });
+  // Steps of pipelines run in background.
+  if (view.isEmpty()) {
+    return;
+  }
   last_execution = exec;
   emit currentTaskChanged();
   SetSelectedExecutionId(exec.id);
   Application::Get().view.SetCurrentView(view);
 }
 
+static bool RunsSameCommand(const entt::registry& registry, entt::entity a,
+                            entt::entity b) {
+  if (registry.all_of<CmakeTask>(a) && registry.all_of<CmakeTask>(b)) {
+    auto& x = registry.get<CmakeTask>(a);
+    auto& y = registry.get<CmakeTask>(b);
+    return x.source_path == y.source_path && x.build_path == y.build_path &&
+           x.profile == y.profile;
+  } else if (registry.all_of<CmakeTargetTask>(a) &&
+             registry.all_of<CmakeTargetTask>(b)) {
+    auto& x = registry.get<CmakeTargetTask>(a);
+    auto& y = registry.get<CmakeTargetTask>(b);
+    return x.build_folder == y.build_folder &&
+           x.target_name == y.target_name &&
+           x.run_after_build == y.run_after_build &&
+           (!x.run_after_build || (x.executable == y.executable &&
+                                   x.executable_args == y.executable_args &&
+                                   x.profiler == y.profiler));
+  } else if (registry.all_of<CmakeBatchBuildTask>(a) &&
+             registry.all_of<CmakeBatchBuildTask>(b)) {
+    auto& x = registry.get<CmakeBatchBuildTask>(a);
+    auto& y = registry.get<CmakeBatchBuildTask>(b);
+    return x.build_folder == y.build_folder &&
+           x.target_names == y.target_names && x.jobs == y.jobs;
+  } else if (registry.all_of<ExecutableTask>(a) &&
+             registry.all_of<ExecutableTask>(b)) {
+    auto& x = registry.get<ExecutableTask>(a);
+    auto& y = registry.get<ExecutableTask>(b);
+    return x.path == y.path && x.args == y.args && x.profiler == y.profiler;
+  }
+  return false;
+}
+
+entt::entity TaskSystem::FindRunningTask(entt::entity e) const {
+  // Executions, that re-run their tasks until they fail, might never finish.
+  for (entt::entity running : registry.view<const TaskExecution>(
+           entt::exclude<RepeatUntilFail, StressWorker>)) {
+    if (running != e && RunsSameCommand(registry, e, running)) {
+      return running;
+    }
+  }
+  return entt::null;
+}
+
+bool TaskSystem::CoalesceWithRunningTask(entt::entity e, const QString& view) {
+  entt::entity running = FindRunningTask(e);
+  if (running == entt::null) {
+    return false;
+  }
+  LOG() << "Task" << registry.get<TaskId>(e)
+        << "is already running - displaying its execution";
+  registry.destroy(e);
+  SetSelectedExecutionId(registry.get<TaskExecution>(running).id);
+  Application::Get().view.SetCurrentView(view);
+  return true;
+}
+
+static QString FindPipelineError(const PipelineTask& pipeline) {
+  QHash<QString, int> dependency_counts;
+  for (const PipelineTask::Step& step : pipeline.steps) {
+    if (dependency_counts.contains(step.name)) {
+      return "There is more than one step called '" + step.name + "'";
+    }
+    dependency_counts[step.name] = step.after.size();
+  }
+  for (const PipelineTask::Step& step : pipeline.steps) {
+    for (const QString& name : step.after) {
+      if (!dependency_counts.contains(name)) {
+        return "Step '" + step.name + "' depends on unknown step '" + name +
+               "'";
+      }
+    }
+  }
+  // Keep removing steps without dependencies: steps, that remain, depend on
+  // each other.
+  QStringList removed;
+  for (const PipelineTask::Step& step : pipeline.steps) {
+    if (step.after.isEmpty()) {
+      removed.append(step.name);
+    }
+  }
+  for (int i = 0; i < removed.size(); i++) {
+    for (const PipelineTask::Step& step : pipeline.steps) {
+      if (step.after.contains(removed[i]) &&
+          --dependency_counts[step.name] == 0) {
+        removed.append(step.name);
+      }
+    }
+  }
+  if (removed.size() < pipeline.steps.size()) {
+    return "Steps depend on each other in a cycle";
+  }
+  return QString();
+}
+
+void TaskSystem::RunPipeline(const TaskId& id, const PipelineTask& pipeline) {
+  LOG() << "Running pipeline" << id;
+  QString error = FindPipelineError(pipeline);
+  if (!error.isEmpty()) {
+    Notification notification("Pipeline '" + pipeline.name + "' is invalid");
+    notification.is_error = true;
+    notification.description = error;
+    Application::Get().notification.Post(notification);
+    return;
+  }
+  entt::entity p = registry.create();
+  auto& run = registry.emplace<PipelineRun>(p);
+  run.name = pipeline.name;
+  run.start_time = QDateTime::currentDateTime();
+  run.unfinished_steps = pipeline.steps.size();
+  QHash<QString, entt::entity> steps;
+  for (int i = 0; i < pipeline.steps.size(); i++) {
+    const PipelineTask::Step& s = pipeline.steps[i];
+    entt::entity e = registry.create();
+    registry.emplace<TaskId>(e, s.task_id);
+    EmplaceTask(registry, e, s.task_id, s.task_data);
+    if (s.output_limits) {
+      registry.emplace<OutputLimits>(e, *s.output_limits);
+    }
+    auto& step = registry.emplace<PipelineStep>(e);
+    step.pipeline = p;
+    step.name = s.name;
+    step.index = i;
+    steps[s.name] = e;
+  }
+  for (const PipelineTask::Step& s : pipeline.steps) {
+    entt::entity e = steps[s.name];
+    for (const QString& name : s.after) {
+      registry.get<PipelineStep>(steps[name]).dependents.append(e);
+      registry.get<PipelineStep>(e).unfinished_dependencies++;
+    }
+  }
+  Application::Get().view.SetCurrentView("TaskExecutionList.qml");
+  ScheduleTasks();
+}
+
+void TaskSystem::ScheduleTasks() {
+  int job_limit =
+      context.job_limit > 0 ? context.job_limit : QThread::idealThreadCount();
+  // Workers of stress runs are accounted for in their runs.
+  auto executions =
+      registry.view<const TaskExecution>(entt::exclude<StressWorker>);
+  int running = std::distance(executions.begin(), executions.end());
+  QList<entt::entity> ready;
+  for (auto [e, step] : registry.view<PipelineStep>().each()) {
+    if (!step.started && step.unfinished_dependencies == 0) {
+      ready.append(e);
+    }
+  }
+  std::sort(ready.begin(), ready.end(), [this](entt::entity a, entt::entity b) {
+    return registry.get<PipelineStep>(a).index <
+           registry.get<PipelineStep>(b).index;
+  });
+  for (entt::entity e : ready) {
+    auto& step = registry.get<PipelineStep>(e);
+    entt::entity running_task = FindRunningTask(e);
+    if (running_task != entt::null) {
+      LOG() << "Pipeline step" << step.name
+            << "waits for already running execution of its task";
+      step.started = true;
+      registry.get_or_emplace<CoalescedSteps>(running_task).steps.append(e);
+    } else if (running < job_limit) {
+      step.started = true;
+      running++;
+      RunExecution(e, false, QString());
+    }
+  }
+}
+
+void TaskSystem::FinishPipelineStep(entt::entity step, int exit_code) {
+  // Copy what we need: destroying other steps moves steps around in memory.
+  PipelineStep s = registry.get<PipelineStep>(step);
+  auto& run = registry.get<PipelineRun>(s.pipeline);
+  run.unfinished_steps--;
+  if (exit_code != 0 && run.failed_step.isEmpty()) {
+    LOG() << "Pipeline" << run.name << "failed at step" << s.name;
+    run.failed_step = s.name;
+    QList<entt::entity> cancelled;
+    for (auto [e, other] : registry.view<PipelineStep>().each()) {
+      if (other.pipeline == s.pipeline && !other.started) {
+        cancelled.append(e);
+      }
+    }
+    run.unfinished_steps -= cancelled.size();
+    registry.destroy(cancelled.begin(), cancelled.end());
+  } else if (run.failed_step.isEmpty()) {
+    for (entt::entity dependent : s.dependents) {
+      registry.get<PipelineStep>(dependent).unfinished_dependencies--;
+    }
+  }
+  if (run.unfinished_steps > 0) {
+    return;
+  }
+  Notification notification;
+  if (run.failed_step.isEmpty()) {
+    notification.title = "Pipeline '" + run.name + "' has succeeded";
+  } else {
+    notification.title = "Pipeline '" + run.name + "' has failed";
+    notification.is_error = true;
+    notification.description = "Step '" + run.failed_step + "' has failed. ";
+  }
+  qint64 secs = run.start_time.secsTo(QDateTime::currentDateTime());
+  notification.description += "Took " + QString::number(secs) + " seconds.";
+  Application::Get().notification.Post(notification);
+  registry.destroy(s.pipeline);
+}
+
 Promise<int> TaskSystem::RunTask(entt::entity e) {
   if (registry.any_of<ExecutableTask>(e)) {
     return RunExecutableTask(e);
@@ -310,6 +1365,8 @@ Promise<int> TaskSystem::RunTask(entt::entity e) {
     return RunCmakeTask(e);
   } else if (registry.any_of<CmakeTargetTask>(e)) {
     return RunCmakeTargetTask(e);
+  } else if (registry.any_of<CmakeBatchBuildTask>(e)) {
+    return RunCmakeBatchBuildTask(e);
   }
   return Promise<int>(-1);
 }
@@ -319,17 +1376,472 @@ Promise<int> TaskSystem::RunTaskUntilFail(entt::entity e) {
     if (exit_code != 0) {
       return Promise<int>(exit_code);
     } else {
-      auto& exec = registry.get<TaskExecution>(e);
-      exec.output.clear();
-      exec.stderr_line_indices.clear();
+      ResetExecutionOutput(e);
       return RunTaskUntilFail(e);
     }
   });
 }
 
+static QString FormatStressRunReport(const StressRun& run,
+                                     const QDateTime& now) {
+  double seconds = std::max(run.start_time.msecsTo(now), 1LL) / 1000.0;
+  QString report = "Iterations: " + QString::number(run.iterations) + " in " +
+                   QString::number(seconds, 'f', 1) + "s (" +
+                   QString::number(run.iterations / seconds, 'f', 1) +
+                   " per second)";
+  // Iterations stop being counted once one of them fails.
+  if (run.failed_exit_code) {
+    report += ", failed after " + QString::number(run.iterations) +
+              " iterations with code " +
+              QString::number(*run.failed_exit_code);
+  }
+  return report;
+}
+
+Promise<int> TaskSystem::RunTaskInParallel(entt::entity e,
+                                           ParallelMode parallel) {
+  bool repeat_until_fail = registry.all_of<RepeatUntilFail>(e);
+  Promise<int> build(0);
+  ExecutableTask task;
+  if (auto t = registry.try_get<CmakeTargetTask>(e); t && t->run_after_build) {
+    // Build the executable once instead of doing it in every copy.
+    build = RunCmakeBuild(e, t->build_folder,
+                          {"--build", t->build_folder, "-t", t->target_name});
+    task.path = t->build_folder + t->executable;
+    task.args = t->executable_args;
+    task.profiler = t->profiler;
+  } else if (auto t = registry.try_get<ExecutableTask>(e)) {
+    task = *t;
+  } else {
+    return repeat_until_fail ? RunTaskUntilFail(e) : RunTask(e);
+  }
+  // Profiles of copies, that run at the same time, would only get in each
+  // other's way, and workers of sharded runs don't have executions to store
+  // them in.
+  if (task.profiler != Profiler::kNone) {
+    AppendToExecutionOutput(
+        e, "Copies of the executable, that run in parallel, are not profiled\n",
+        false);
+    task.profiler = Profiler::kNone;
+  }
+  return build.Then<int>(this, [this, e, task, parallel](int exit_code) {
+    if (exit_code != 0) {
+      return Promise<int>(exit_code);
+    } else if (parallel == ParallelMode::kStress) {
+      return StartStressRun(e, task);
+    } else if (parallel == ParallelMode::kQtestFunctions) {
+      return StartQtestRun(e, task);
+    } else {
+      return StartShardedRun(e, task);
+    }
+  });
+}
+
+Promise<int> TaskSystem::StartQtestRun(entt::entity e,
+                                       const ExecutableTask& task) {
+  Promise<QStringList> functions =
+      IoTask::Run<QStringList>([task] { return ListQtestFunctionsSync(task); });
+  return functions.Then<int>(this, [this, e, task](QStringList functions) {
+    if (!registry.valid(e)) {
+      return Promise<int>(-1);
+    }
+    int jobs = context.job_limit > 0 ? context.job_limit
+                                     : QThread::idealThreadCount();
+    // Each process runs initTestCase() and cleanupTestCase() of its own, so
+    // test functions are run in batches, that are still small enough to keep
+    // all the workers busy until the very end.
+    int batch_size = std::max(1, static_cast<int>(functions.size()) / jobs / 4);
+    QList<QStringList> batches;
+    for (int i = 0; i < functions.size(); i += batch_size) {
+      batches.append(functions.mid(i, batch_size));
+    }
+    if (batches.isEmpty()) {
+      // Run all the test functions, since we don't know them.
+      batches.append(QStringList());
+    }
+    return StartShardedRun(e, task, batches);
+  });
+}
+
+Promise<int> TaskSystem::StartShardedRun(entt::entity e,
+                                         const ExecutableTask& task,
+                                         const QList<QStringList>& batches) {
+  int shards =
+      context.job_limit > 0 ? context.job_limit : QThread::idealThreadCount();
+  // Google Test executables split their tests into shards themselves.
+  bool is_gtest = batches.isEmpty();
+  if (!is_gtest) {
+    shards = std::min(shards, static_cast<int>(batches.size()));
+  }
+  LOG() << "Running" << task.path << "in" << shards << "shards";
+  AppendToExecutionOutput(e,
+                          "[shards " + QString::number(shards) + "] Running " +
+                              task.path + '\n',
+                          false);
+  auto& run = registry.emplace<ShardedRun>(e);
+  run.promise = QSharedPointer<QPromise<int>>::create();
+  run.args = task.args;
+  run.batches = batches;
+  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+  env.insert("GTEST_TOTAL_SHARDS", QString::number(shards));
+  for (int i = 0; i < shards; i++) {
+    entt::entity worker = registry.create();
+    registry.emplace<TaskId>(worker, registry.get<TaskId>(e));
+    registry.emplace<ExecutableTask>(worker, task);
+    auto& shard = registry.emplace<ShardWorker>(worker);
+    shard.run = e;
+    shard.prefix = "[shard " + QString::number(i) + '/' +
+                   QString::number(shards) + "] ";
+    auto& p = registry.emplace<QProcess>(worker);
+    if (is_gtest) {
+      env.insert("GTEST_SHARD_INDEX", QString::number(i));
+      p.setProcessEnvironment(env);
+    }
+    registry.emplace<PendingOutput>(worker);
+    run.workers.append(worker);
+  }
+  for (entt::entity worker : run.workers) {
+    RunShard(worker);
+  }
+  return run.promise->future();
+}
+
+void TaskSystem::RunShard(entt::entity worker) {
+  auto& run = registry.get<ShardedRun>(registry.get<ShardWorker>(worker).run);
+  if (!run.batches.isEmpty()) {
+    registry.get<ExecutableTask>(worker).args =
+        run.args + run.batches.takeFirst();
+  }
+  RunExecutableTask(worker).Then(this, [this, worker](int exit_code) {
+    FinishShard(worker, exit_code);
+  });
+}
+
+void TaskSystem::ForwardShardOutput(entt::entity worker, const QString& data,
+                                    bool is_stderr, bool flush) {
+  auto& shard = registry.get<ShardWorker>(worker);
+  QString& line = is_stderr ? shard.stderr_line : shard.stdout_line;
+  QString text = line + data;
+  QString lines;
+  int pos = 0;
+  while (true) {
+    int i = text.indexOf('\n', pos);
+    if (i < 0 && flush && pos < text.size()) {
+      i = text.size();
+    }
+    if (i < 0) {
+      break;
+    }
+    QStringView l = QStringView(text).sliced(pos, i - pos);
+    if (l.endsWith('\r')) {
+      l.chop(1);
+    }
+    // A line, that has been redrawn in place, would overwrite the prefix.
+    l = l.sliced(l.lastIndexOf('\r') + 1);
+    lines += shard.prefix;
+    lines += l;
+    lines += '\n';
+    pos = i + 1;
+  }
+  line = pos < text.size() ? text.sliced(pos) : QString();
+  AppendToExecutionOutput(shard.run, lines, is_stderr);
+}
+
+void TaskSystem::FinishShard(entt::entity worker, int exit_code) {
+  if (!registry.valid(worker) || !registry.all_of<ShardWorker>(worker)) {
+    return;
+  }
+  ForwardShardOutput(worker, "", false, true);
+  ForwardShardOutput(worker, "", true, true);
+  entt::entity e = registry.get<ShardWorker>(worker).run;
+  auto& run = registry.get<ShardedRun>(e);
+  LOG() << registry.get<ShardWorker>(worker).prefix << "of"
+        << registry.get<TaskId>(e) << "finished with code" << exit_code;
+  if (run.exit_code == 0) {
+    run.exit_code = exit_code;
+  }
+  if (!run.batches.isEmpty()) {
+    RunShard(worker);
+    return;
+  }
+  run.workers.removeOne(worker);
+  registry.destroy(worker);
+  if (!run.workers.isEmpty()) {
+    return;
+  }
+  PublishExecutionOutput(e);
+  auto promise = run.promise;
+  exit_code = run.exit_code;
+  registry.remove<ShardedRun>(e);
+  promise->addResult(exit_code);
+  promise->finish();
+}
+
+void TaskSystem::StopShardedRun(entt::entity e) {
+  auto& run = registry.get<ShardedRun>(e);
+  run.batches.clear();
+  for (entt::entity worker : run.workers) {
+    registry.get<QProcess>(worker).kill();
+  }
+}
+
+Promise<int> TaskSystem::StartStressRun(entt::entity e,
+                                        const ExecutableTask& task) {
+  int copies =
+      context.job_limit > 0 ? context.job_limit : QThread::idealThreadCount();
+  LOG() << "Running" << copies << "copies of" << task.path
+        << "until one of them fails";
+  AppendToExecutionOutput(e,
+                          "Running " + QString::number(copies) + " copies of " +
+                              task.path + " until one of them fails\n",
+                          false);
+  auto& run = registry.emplace<StressRun>(e);
+  run.promise = QSharedPointer<QPromise<int>>::create();
+  run.start_time = QDateTime::currentDateTime();
+  run.last_report_time = run.start_time;
+  for (int i = 0; i < copies; i++) {
+    entt::entity worker = registry.create();
+    registry.emplace<TaskId>(worker, registry.get<TaskId>(e));
+    registry.emplace<ExecutableTask>(worker, task);
+    registry.emplace<StressWorker>(worker, e);
+    registry.emplace<TaskExecution>(worker).id = QUuid::createUuid();
+    registry.emplace<QProcess>(worker);
+    registry.emplace<PendingOutput>(worker);
+    run.workers.append(worker);
+  }
+  for (entt::entity worker : run.workers) {
+    RunStressIteration(worker);
+  }
+  return run.promise->future();
+}
+
+void TaskSystem::RunStressIteration(entt::entity worker) {
+  RunExecutableTask(worker).Then(this, [this, worker](int exit_code) {
+    FinishStressIteration(worker, exit_code);
+  });
+}
+
+void TaskSystem::FinishStressIteration(entt::entity worker, int exit_code) {
+  if (!registry.valid(worker) || !registry.all_of<StressWorker>(worker)) {
+    return;
+  }
+  entt::entity e = registry.get<StressWorker>(worker).run;
+  auto& run = registry.get<StressRun>(e);
+  if (!run.stopping) {
+    run.iterations++;
+    if (exit_code == 0) {
+      ResetExecutionOutput(worker);
+      QDateTime now = QDateTime::currentDateTime();
+      if (run.last_report_time.msecsTo(now) >= 1000) {
+        run.last_report_time = now;
+        AppendToExecutionOutput(
+            e, '\r' + FormatStressRunReport(run, now), false);
+      }
+      RunStressIteration(worker);
+      return;
+    }
+    LOG() << "Copy of" << registry.get<TaskId>(e) << "failed with code"
+          << exit_code << "after" << run.iterations << "iterations";
+    auto& exec = registry.get<TaskExecution>(worker);
+    run.failed_exit_code = exit_code;
+    run.failed_output = exec.output;
+    run.failed_stderr_line_indices = exec.stderr_line_indices;
+    StopStressRun(e);
+  }
+  run.workers.removeOne(worker);
+  registry.destroy(worker);
+  if (run.workers.isEmpty()) {
+    FinishStressRun(e);
+  }
+}
+
+void TaskSystem::StopStressRun(entt::entity e) {
+  auto& run = registry.get<StressRun>(e);
+  run.stopping = true;
+  for (entt::entity worker : run.workers) {
+    registry.get<QProcess>(worker).kill();
+  }
+}
+
+void TaskSystem::FinishStressRun(entt::entity e) {
+  auto& run = registry.get<StressRun>(e);
+  QString report = FormatStressRunReport(run, QDateTime::currentDateTime());
+  AppendToExecutionOutput(e, '\r' + report + '\n', false);
+  if (run.failed_exit_code) {
+    // Copy output of the failed iteration, keeping track of which of its lines
+    // have been printed to stderr.
+    const TextBuffer& output = run.failed_output;
+    auto append_lines = [this, e, &output](int first, int last,
+                                           bool is_stderr) {
+      last = std::min(last, output.GetLineCount());
+      if (first >= last) {
+        return;
+      }
+      int start = output.GetLineOffset(first);
+      int end = last < output.GetLineCount() ? output.GetLineOffset(last)
+                                             : output.GetSize();
+      AppendToExecutionOutput(e, output.GetText(start, end - start),
+                              is_stderr);
+    };
+    AppendToExecutionOutput(e, "Output of the failed iteration:\n", false);
+    int line = 0;
+    for (auto [first, last] : run.failed_stderr_line_indices.GetIntervals()) {
+      append_lines(line, first, false);
+      append_lines(first, last + 1, true);
+      line = last + 1;
+    }
+    append_lines(line, output.GetLineCount(), false);
+  }
+  PublishExecutionOutput(e);
+  auto promise = run.promise;
+  int exit_code = run.failed_exit_code.value_or(0);
+  registry.remove<StressRun>(e);
+  promise->addResult(exit_code);
+  promise->finish();
+}
+
+void TaskSystem::ResetExecutionOutput(entt::entity e) {
+  auto& exec = registry.get<TaskExecution>(e);
+  exec.output.Clear();
+  exec.stderr_line_indices.Clear();
+  exec.line_times.Clear();
+  exec.elided_size = 0;
+  exec.elided_line_count = 0;
+  registry.remove<ElidedOutput>(e);
+  if (auto pending = registry.try_get<PendingOutput>(e)) {
+    pending->clock.invalidate();
+  }
+}
+
 Promise<int> TaskSystem::RunExecutableTask(entt::entity e) {
   auto& t = registry.get<ExecutableTask>(e);
-  return RunProcess(e, t.path, t.args);
+  return RunProfiledProcess(e, t.path, t.args, t.profiler);
+}
+
+Promise<int> TaskSystem::RunProfiledProcess(entt::entity e,
+                                            const QString& exe,
+                                            const QStringList& args,
+                                            Profiler profiler) {
+  if (profiler == Profiler::kNone) {
+    return RunProcess(e, exe, args);
+  }
+  QString folder = GetOutputFolder();
+  QString data_path =
+      folder + '/' +
+      registry.get<TaskExecution>(e).id.toString(QUuid::WithoutBraces);
+  QString program = "perf";
+  QStringList program_args;
+  if (profiler == Profiler::kSampling) {
+    data_path += ".perf.data";
+    program_args = {"record", "-g", "-o", data_path, "--", exe};
+    program_args += args;
+  } else if (profiler == Profiler::kCounters) {
+    data_path += ".perf-stat.csv";
+    program_args = {"stat", "-x",  ",", "-o", data_path, "-e",
+                    PerfCounters::GetEvents(), "--", exe};
+    program_args += args;
+  } else {
+    // The executable gets run as is, while the library, that gets preloaded
+    // into it, writes the profile once it exits.
+    data_path += ".alloc-profile";
+    program = exe;
+    program_args = args;
+    // The process can be run again, so its environment is built from scratch
+    // each time, instead of adding the library to it once more.
+    auto& p = registry.get<QProcess>(e);
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    QString preload = AllocationProfile::GetLibraryPath();
+    if (env.contains("LD_PRELOAD")) {
+      preload += ':' + env.value("LD_PRELOAD");
+    }
+    env.insert("LD_PRELOAD", preload);
+    env.insert("CDT_ALLOC_PROFILE", data_path);
+    p.setProcessEnvironment(env);
+  }
+  return IoTask::Run([folder] { QDir().mkpath(folder); })
+      .Then<int>(this,
+                 [this, e, program, program_args]() {
+                   if (!registry.valid(e) ||
+                       !registry.all_of<TaskExecution>(e)) {
+                     return Promise<int>(-1);
+                   }
+                   return RunProcess(e, program, program_args);
+                 })
+      .Then<int>(this, [this, e, data_path, profiler](int exit_code) {
+        if (profiler == Profiler::kSampling) {
+          return FinishSamplingProfile(e, exit_code, data_path);
+        } else if (profiler == Profiler::kCounters) {
+          return FinishCounters(e, exit_code, data_path);
+        } else {
+          return FinishAllocationProfile(e, exit_code, data_path);
+        }
+      });
+}
+
+Promise<int> TaskSystem::FinishCounters(entt::entity e, int exit_code,
+                                        const QString& data_path) {
+  Promise<PerfCounters> counters = IoTask::Run<PerfCounters>([data_path] {
+    PerfCounters counters = PerfCounters::ParseSync(data_path);
+    QFile::remove(data_path);
+    return counters;
+  });
+  return counters.Then<int>(this, [this, e, exit_code](PerfCounters c) {
+    if (registry.valid(e) && registry.all_of<TaskExecution>(e) &&
+        !c.IsNull()) {
+      registry.get<TaskExecution>(e).perf_counters = c;
+      AppendToExecutionOutput(e, c.FormatReport(), false);
+    }
+    return Promise<int>(exit_code);
+  });
+}
+
+Promise<int> TaskSystem::FinishSamplingProfile(entt::entity e, int exit_code,
+                                               const QString& data_path) {
+  Promise<CpuProfile> profile = QtConcurrent::run([data_path] {
+    CpuProfile profile = CpuProfile::CreateSync(data_path);
+    QFile::remove(data_path);
+    return profile;
+  });
+  return profile.Then<int>(this, [this, e, exit_code](CpuProfile profile) {
+    if (registry.valid(e) && registry.all_of<TaskExecution>(e) &&
+        !profile.IsNull()) {
+      registry.get<TaskExecution>(e).cpu_profile = profile;
+      AppendToExecutionOutput(
+          e,
+          "\n" + QString::number(profile.sample_count) +
+              " samples are available in the flame graph\n",
+          false);
+    }
+    return Promise<int>(exit_code);
+  });
+}
+
+Promise<int> TaskSystem::FinishAllocationProfile(entt::entity e,
+                                                 int exit_code,
+                                                 const QString& data_path) {
+  Promise<AllocationProfile> profile = QtConcurrent::run([data_path] {
+    AllocationProfile profile =
+        AllocationProfile::ParseSync(data_path, kAllocationSiteCount);
+    QFile::remove(data_path);
+    return profile;
+  });
+  return profile.Then<int>(
+      this, [this, e, exit_code](AllocationProfile profile) {
+        if (!registry.valid(e) || !registry.all_of<TaskExecution>(e)) {
+          return Promise<int>(exit_code);
+        }
+        if (profile.IsNull()) {
+          AppendToExecutionOutput(
+              e,
+              "\nAllocation profile has not been written: make sure, that " +
+                  AllocationProfile::GetLibraryPath() + " exists\n",
+              true);
+        } else {
+          registry.get<TaskExecution>(e).allocation_profile = profile;
+          AppendToExecutionOutput(e, profile.FormatReport(), false);
+        }
+        return Promise<int>(exit_code);
+      });
 }
 
 void TaskSystem::CreateCmakeQueryFilesSync(const QString& path) {
@@ -346,46 +1858,161 @@ void TaskSystem::CreateCmakeQueryFilesSync(const QString& path) {
   }
 }
 
+static QString GetProfilerPrefix(Profiler profiler) {
+  switch (profiler) {
+    case Profiler::kSampling:
+      return "Profile ";
+    case Profiler::kCounters:
+      return "Measure ";
+    case Profiler::kAllocations:
+      return "Profile Allocations of ";
+    default:
+      return "";
+  }
+}
+
 QString TaskSystem::GetTaskName(const entt::registry& registry,
                                 entt::entity e) {
   if (registry.any_of<ExecutableTask>(e)) {
     auto& t = registry.get<const ExecutableTask>(e);
-    return Path::GetFileName(t.path);
+    return GetProfilerPrefix(t.profiler) + Path::GetFileName(t.path);
   } else if (registry.any_of<CmakeTask>(e)) {
     auto& t = registry.get<CmakeTask>(e);
-    return "CMake " + t.source_path;
+    return (t.profile ? "Profile CMake " : "CMake ") + t.source_path;
   } else if (registry.any_of<CmakeTargetTask>(e)) {
     auto& t = registry.get<CmakeTargetTask>(e);
     QString result = "Build ";
     if (t.run_after_build) {
-      result += "& Run ";
+      result = GetProfilerPrefix(t.profiler) + result + "& Run ";
     }
     return result + t.target_name;
+  } else if (registry.any_of<CmakeBatchBuildTask>(e)) {
+    auto& t = registry.get<CmakeBatchBuildTask>(e);
+    return "Build " + t.target_names.join(", ");
+  } else if (registry.any_of<PipelineTask>(e)) {
+    auto& t = registry.get<PipelineTask>(e);
+    return "Pipeline " + t.name;
   } else {
     return registry.get<TaskId>(e);
   }
 }
 
-void TaskSystem::RunTaskOfExecution(const TaskExecution& exec,
-                                    bool repeat_until_fail, const QString& view,
-                                    const QStringList& executable_args) {
-  if (exec.IsNull()) {
-    return;
+QStringList TaskSystem::ListQtestFunctionsSync(const ExecutableTask& task) {
+  LOG() << "Listing test functions of" << task.path;
+  QStringList functions;
+  QProcess proc;
+  proc.start(task.path, QStringList(task.args) << "-functions");
+  if (!proc.waitForFinished() || proc.exitCode() != 0) {
+    LOG() << "Failed to list test functions of" << task.path;
+    return functions;
   }
-  LOG() << "Running task of execution" << exec.id;
-  QJsonDocument d = QJsonDocument::fromJson(exec.task_data);
-  if (exec.task_id.startsWith("cmake:")) {
+  QTextStream stream(&proc);
+  while (!stream.atEnd()) {
+    QString line = stream.readLine().trimmed();
+    if (line.endsWith("()")) {
+      functions.append(line.chopped(2));
+    }
+  }
+  return functions;
+}
+
+QString TaskSystem::GetOutputFolder() {
+  QString home = QStandardPaths::writableLocation(QStandardPaths::HomeLocation);
+#ifdef NDEBUG
+  return home + "/.cpp-dev-tools-output";
+#else
+  return home + "/.cpp-dev-tools-output.dev";
+#endif
+}
+
+void TaskSystem::WriteOutputPiecesSync(QUuid exec_id,
+                                       const TextBuffer& output) {
+  QList<TextBuffer::Piece> pieces = output.SplitIntoPieces();
+  int new_pieces = 0;
+  for (int i = 0; i < pieces.size(); i++) {
+    const TextBuffer::Piece& piece = pieces[i];
+    // Re-running the same task tends to produce mostly the same output, parts
+    // of which are already stored by previous executions.
+    QList<int> existing = Database::ExecQueryAndRead<int>(
+        "SELECT 1 FROM task_output_chunk WHERE hash=?",
+        &Database::ReadIntFromSql, {piece.hash});
+    if (existing.isEmpty()) {
+      QString text = output.GetText(piece.offset, piece.length);
+      Database::ExecCmd("INSERT INTO task_output_chunk VALUES(?,?)",
+                        {piece.hash, TextBuffer::CompressPiece(text)});
+      new_pieces++;
+    }
+    Database::ExecCmd(
+        "INSERT INTO task_execution_output_chunk VALUES(?,?,?,?)",
+        {exec_id, i, piece.hash, piece.length});
+  }
+  LOG() << "Stored output of execution" << exec_id << "in" << pieces.size()
+        << "chunks," << new_pieces << "of them new";
+}
+
+void TaskSystem::RemoveExecutionsSync(const QString& condition,
+                                      const QVariantList& args) {
+  QStringList files = Database::ExecQueryAndRead<QString>(
+      "SELECT output_file FROM task_execution WHERE output_file IS NOT NULL "
+      "AND " +
+          condition,
+      &Database::ReadStringFromSql, args);
+  Database::ExecCmd("DELETE FROM task_execution WHERE " + condition, args);
+  RemoveUnusedOutputPiecesSync();
+  for (const QString& file : files) {
+    LOG() << "Removing output file" << file;
+    QFile::remove(file);
+  }
+}
+
+void TaskSystem::RemoveUnusedOutputPiecesSync() {
+  Database::ExecCmd(
+      "DELETE FROM task_output_chunk WHERE hash NOT IN "
+      "(SELECT hash FROM task_execution_output_chunk)");
+}
+
+void TaskSystem::RemoveOrphanedOutputFilesSync() {
+  // Files, that are still being written by executions, that are running in
+  // other instances of the app, are not referenced by the database yet, so
+  // only files, that haven't been touched for a while, are removed.
+  static constexpr int kOrphanedFileAgeDays = 1;
+  QSet<QString> output_files;
+  for (const QString& file : Database::ExecQueryAndRead<QString>(
+           "SELECT output_file FROM task_execution "
+           "WHERE output_file IS NOT NULL",
+           &Database::ReadStringFromSql)) {
+    output_files.insert(file);
+  }
+  QDateTime stale_time =
+      QDateTime::currentDateTime().addDays(-kOrphanedFileAgeDays);
+  QDir output_folder(GetOutputFolder());
+  for (const QFileInfo& file : output_folder.entryInfoList(QDir::Files)) {
+    if (!output_files.contains(file.absoluteFilePath()) &&
+        file.lastModified() < stale_time) {
+      LOG() << "Removing orphaned output file" << file.absoluteFilePath();
+      QFile::remove(file.absoluteFilePath());
+    }
+  }
+}
+
+void TaskSystem::EmplaceTask(entt::registry& registry, entt::entity e,
+                             const TaskId& id, const QByteArray& task_data,
+                             const QStringList& executable_args) {
+  QJsonDocument d = QJsonDocument::fromJson(task_data);
+  if (id.startsWith("cmake:")) {
     CmakeTask t{
         d["source_path"].toString(),
         d["build_path"].toString(),
+        d["profile"].toBool(),
     };
-    RunTask(exec.task_id, t, repeat_until_fail, view);
-  } else if (exec.task_id.startsWith("cmake-target:")) {
+    registry.emplace<CmakeTask>(e, t);
+  } else if (id.startsWith("cmake-target:")) {
     CmakeTargetTask t;
     t.build_folder = d["build_folder"].toString();
     t.target_name = d["target_name"].toString();
     t.executable = d["executable"].toString();
     t.run_after_build = d["run_after_build"].toBool();
+    t.profiler = static_cast<Profiler>(d["profiler"].toInt());
     if (executable_args.isEmpty()) {
       for (const QJsonValue& arg : d["executable_args"].toArray()) {
         t.executable_args.append(arg.toString());
@@ -397,10 +2024,19 @@ void TaskSystem::RunTaskOfExecution(const TaskExecution& exec,
         }
       }
     }
-    RunTask(exec.task_id, t, repeat_until_fail, view);
-  } else if (exec.task_id.startsWith("exec:")) {
+    registry.emplace<CmakeTargetTask>(e, t);
+  } else if (id.startsWith("cmake-batch:")) {
+    CmakeBatchBuildTask t;
+    t.build_folder = d["build_folder"].toString();
+    for (const QJsonValue& target : d["target_names"].toArray()) {
+      t.target_names.append(target.toString());
+    }
+    t.jobs = d["jobs"].toInt();
+    registry.emplace<CmakeBatchBuildTask>(e, t);
+  } else if (id.startsWith("exec:")) {
     ExecutableTask t;
     t.path = d["path"].toString();
+    t.profiler = static_cast<Profiler>(d["profiler"].toInt());
     if (executable_args.isEmpty()) {
       for (const QJsonValue& arg : d["args"].toArray()) {
         t.args.append(arg.toString());
@@ -412,57 +2048,387 @@ void TaskSystem::RunTaskOfExecution(const TaskExecution& exec,
         }
       }
     }
-    RunTask(exec.task_id, t, repeat_until_fail, view);
+    registry.emplace<ExecutableTask>(e, t);
   } else {
-    qFatal() << "Failed to execute task" << exec.task_id << "of unknown type";
+    qFatal() << "Failed to execute task" << id << "of unknown type";
+  }
+}
+
+void TaskSystem::RunTaskOfExecution(const TaskExecution& exec,
+                                    bool repeat_until_fail, const QString& view,
+                                    const QStringList& executable_args) {
+  if (exec.IsNull()) {
+    return;
+  }
+  LOG() << "Running task of execution" << exec.id;
+  entt::entity e = registry.create();
+  registry.emplace<TaskId>(e, exec.task_id);
+  EmplaceTask(registry, e, exec.task_id, exec.task_data, executable_args);
+  if (!repeat_until_fail && CoalesceWithRunningTask(e, view)) {
+    return;
+  }
+  RunExecution(e, repeat_until_fail, view);
+}
+
+void TaskSystem::RunTaskOfExecutionOnChanges(const TaskExecution& exec,
+                                             const QString& view) {
+  if (exec.IsNull()) {
+    return;
   }
+  entt::entity e = registry.create();
+  registry.emplace<TaskId>(e, exec.task_id);
+  EmplaceTask(registry, e, exec.task_id, exec.task_data);
+  WatchTask(e, view);
 }
 
 Promise<int> TaskSystem::RunCmakeTask(entt::entity e) {
   auto& t = registry.get<CmakeTask>(e);
   auto exists = QSharedPointer<bool>::create(false);
-  return IoTask::Run([t, exists] {
+  QString trace_path = QDir(t.build_path).filePath(kCmakeTraceFileName);
+  return IoTask::Run([t, exists, trace_path] {
            *exists = !QDir(t.build_path).isEmpty();
            if (!*exists) {
              CreateCmakeQueryFilesSync(t.build_path);
            }
+           // Trace of a previous configure should not be mistaken for the
+           // trace of this one.
+           QFile::remove(trace_path);
          })
       .Then<int>(this,
-                 [t, this, e]() {
-                   return RunProcess(e, "cmake",
-                                     {"-B", t.build_path, "-S", t.source_path});
+                 [t, this, e, trace_path]() {
+                   QStringList args = {"-B", t.build_path, "-S",
+                                       t.source_path};
+                   if (t.profile) {
+                     args.append({"--profiling-format=google-trace",
+                                  "--profiling-output=" + trace_path});
+                   }
+                   return RunProcess(e, "cmake", args);
                  })
-      .Then<int>(this, [t, exists](int exit_code) {
+      .Then<int>(this, [t, exists, this, e, trace_path](int exit_code) {
         if (exit_code != 0 && !*exists) {
           // In case the build folder didn't exist before this invocation and we
           // are the ones who created it, if the cmake command fails - we need
           // to clean the folder up. Otherwise we would just keep on
           // uncontrollably creating new build folders.
           IoTask::Run([t] { QDir(t.build_path).removeRecursively(); });
+          return Promise<int>(exit_code);
         }
-        return Promise<int>(exit_code);
+        return FinishCmakeTask(e, exit_code, trace_path);
       });
 }
 
+Promise<int> TaskSystem::FinishCmakeTask(entt::entity e, int exit_code,
+                                         const QString& trace_path) {
+  if (!registry.valid(e) || !registry.all_of<CmakeTask, TaskExecution>(e)) {
+    return Promise<int>(exit_code);
+  }
+  const auto& t = registry.get<CmakeTask>(e);
+  const auto& exec = registry.get<TaskExecution>(e);
+  // Only successful configures are comparable with each other.
+  qint64 duration = exit_code == 0 ? exec.start_time.msecsTo(
+                                         QDateTime::currentDateTime())
+                                   : -1;
+  bool profile = t.profile;
+  QString build_path = t.build_path;
+  QUuid project_id = Application::Get().project.GetCurrentProject().id;
+  using Reports = std::pair<ConfigureReport, CmakeProfile>;
+  Promise<Reports> reports = IoTask::Run<Reports>(
+      [profile, build_path, trace_path, duration, project_id] {
+        ConfigureReport report;
+        if (duration >= 0) {
+          report = ConfigureReport::CreateSync(project_id, build_path,
+                                               duration);
+        }
+        CmakeProfile cmake_profile;
+        if (profile) {
+          cmake_profile = CmakeProfile::ParseSync(trace_path);
+        }
+        return std::make_pair(report, cmake_profile);
+      });
+  return reports.Then<int>(this, [this, e, exit_code](Reports reports) {
+    if (registry.valid(e) && registry.all_of<TaskExecution>(e)) {
+      if (reports.first.duration > 0) {
+        AppendToExecutionOutput(e, reports.first.Format(), false);
+      }
+      if (!reports.second.IsNull()) {
+        registry.get<TaskExecution>(e).cmake_profile = reports.second;
+        AppendToExecutionOutput(
+            e,
+            "Profile of " + QString::number(reports.second.call_count) +
+                " CMake calls is available in the CMake profile\n",
+            false);
+      }
+    }
+    return Promise<int>(exit_code);
+  });
+}
+
 Promise<int> TaskSystem::RunCmakeTargetTask(entt::entity e) {
   auto& t = registry.get<CmakeTargetTask>(e);
-  Promise<int> r =
-      RunProcess(e, "cmake", {"--build", t.build_folder, "-t", t.target_name});
+  Promise<int> r = RunCmakeBuild(
+      e, t.build_folder, {"--build", t.build_folder, "-t", t.target_name});
   if (t.run_after_build) {
     r = r.Then<int>(this, [this, e, t](int code) {
       if (code != 0) {
         return Promise<int>(code);
       }
-      return RunProcess(e, t.build_folder + t.executable, t.executable_args);
+      return RunProfiledProcess(e, t.build_folder + t.executable,
+                                t.executable_args, t.profiler);
     });
   }
   return r;
 }
 
+// Index of the target of a batch build, that a line of the build tool's output
+// is about, or -1. Both Ninja and Make mention object files of a target, that
+// are located in its "CMakeFiles/<target>.dir" folder. Make also reports
+// built targets, while Ninja only reports linking their artifacts.
+static int FindBatchBuildTarget(const QStringList& targets,
+                                const QString& line) {
+  for (int i = 0; i < targets.size(); i++) {
+    const QString& target = targets[i];
+    if (line.contains("CMakeFiles/" + target + ".dir/") ||
+        line.endsWith("Built target " + target)) {
+      return i;
+    }
+  }
+  if (!line.contains("Linking ")) {
+    return -1;
+  }
+  // Path of the artifact goes last.
+  QString name = line.trimmed();
+  name = Path::GetFileName(name.sliced(name.lastIndexOf(' ') + 1));
+  if (name.startsWith("lib")) {
+    name.remove(0, 3);
+  }
+  name = name.left(name.indexOf('.'));
+  return targets.indexOf(name);
+}
+
+static QString FormatBatchBuildTimes(const BatchBuildTimes& build) {
+  QList<int> order;
+  for (int i = 0; i < build.targets.size(); i++) {
+    order.append(i);
+  }
+  std::stable_sort(order.begin(), order.end(), [&build](int a, int b) {
+    return build.times[a].GetDuration() > build.times[b].GetDuration();
+  });
+  QString result = "\nBuild time of each target:\n";
+  for (int i : order) {
+    const BatchBuildTimes::Time& time = build.times[i];
+    result += "  " + build.targets[i] + ": ";
+    if (time.end < 0) {
+      result += "up to date\n";
+    } else {
+      result += QString::number(time.GetDuration() / 1000.0, 'f', 1) + "s\n";
+    }
+  }
+  return result;
+}
+
+Promise<int> TaskSystem::RunCmakeBatchBuildTask(entt::entity e) {
+  auto& t = registry.get<CmakeBatchBuildTask>(e);
+  int jobs = t.jobs;
+  if (jobs <= 0) {
+    jobs = context.job_limit > 0 ? context.job_limit
+                                 : QThread::idealThreadCount();
+  }
+  auto& build = registry.emplace_or_replace<BatchBuildTimes>(e);
+  build.targets = t.target_names;
+  build.times.resize(t.target_names.size());
+  QStringList args = {"--build", t.build_folder, "-j", QString::number(jobs),
+                      "-t"};
+  args.append(t.target_names);
+  return RunCmakeBuild(e, t.build_folder, args)
+      .Then<int>(this, [this, e](int code) {
+        if (registry.all_of<BatchBuildTimes>(e)) {
+          // Lines, that are still pending, might mention targets too.
+          PublishExecutionOutput(e);
+          AppendToExecutionOutput(
+              e, FormatBatchBuildTimes(registry.get<BatchBuildTimes>(e)),
+              false);
+        }
+        return Promise<int>(code);
+      });
+}
+
+void TaskSystem::TrackBatchBuildTargets(entt::entity e, int first_line,
+                                        int last_line) {
+  auto& build = registry.get<BatchBuildTimes>(e);
+  const auto& exec = registry.get<TaskExecution>(e);
+  for (int i = first_line; i < last_line; i++) {
+    int target = FindBatchBuildTarget(build.targets, exec.output.GetLine(i));
+    if (target < 0) {
+      continue;
+    }
+    BatchBuildTimes::Time& time = build.times[target];
+    qint64 end = exec.line_times.GetTime(i);
+    if (time.start < 0) {
+      // Ninja prints a step once it finishes, so the first step of the target
+      // has started no later than the step before it has finished.
+      time.start = i > 0 ? exec.line_times.GetTime(i - 1) : end;
+    }
+    time.end = end;
+  }
+}
+
+Promise<int> TaskSystem::RunCmakeBuild(entt::entity e,
+                                       const QString& build_folder,
+                                       const QStringList& args) {
+  // Only the steps, that get logged after the build starts, belong to it.
+  QString log_path = NinjaLog::GetPath(build_folder);
+  Promise<qint64> log_size = IoTask::Run<qint64>(
+      [log_path] { return NinjaLog::GetSizeSync(log_path); });
+  return log_size
+      .Then<int>(this,
+                 [this, e, build_folder, log_path, args](qint64 log_size) {
+                   if (!registry.valid(e) ||
+                       !registry.all_of<TaskExecution>(e)) {
+                     return Promise<int>(-1);
+                   }
+                   auto& build = registry.emplace_or_replace<RunningBuild>(e);
+                   build.build_folder = build_folder;
+                   build.log_path = log_path;
+                   build.log_offset = log_size;
+                   build.start_time = QDateTime::currentDateTime();
+                   registry.get<TaskExecution>(e).build_progress =
+                       BuildProgress();
+                   return RunProcess(e, "cmake", args);
+                 })
+      .Then<int>(this, [this, e](int exit_code) {
+        if (!registry.valid(e) || !registry.all_of<RunningBuild>(e)) {
+          return Promise<int>(exit_code);
+        }
+        return FinishBuild(e, exit_code);
+      });
+}
+
+Promise<int> TaskSystem::FinishBuild(entt::entity e, int exit_code) {
+  auto& build = registry.get<RunningBuild>(e);
+  // Results of a read, that is still in progress, will be ignored, since
+  // this read starts from the same offset.
+  build.finished = true;
+  QString path = build.log_path;
+  qint64 offset = build.log_offset;
+  QList<NinjaLogEntry> steps = build.steps;
+  QString build_folder = build.build_folder;
+  QDateTime start_time = build.start_time;
+  QUuid project_id = Application::Get().project.GetCurrentProject().id;
+  using StepsAndReport = std::pair<QList<NinjaLogEntry>, BuildReport>;
+  Promise<StepsAndReport> build_report = IoTask::Run<StepsAndReport>(
+      [path, offset, steps, build_folder, project_id]() mutable {
+        steps.append(NinjaLog::ReadSync(path, offset));
+        BuildReport report = BuildReport::CreateSync(
+            project_id, build_folder, steps, kSlowestBuildStepCount);
+        return std::make_pair(steps, report);
+      });
+  return build_report.Then<int>(this, [this, e, exit_code, build_folder,
+                                       start_time](StepsAndReport result) {
+    if (!registry.valid(e) || !registry.all_of<TaskExecution>(e)) {
+      return Promise<int>(exit_code);
+    }
+    if (!result.second.IsNull()) {
+      AppendToExecutionOutput(e, result.second.Format(), false);
+    }
+    QList<NinjaLogEntry> steps = result.first;
+    Promise<TimeTraceReport> time_trace_report =
+        QtConcurrent::run([build_folder, steps, start_time] {
+          QStringList traces =
+              TimeTraceReport::FindTracesSync(build_folder, steps, start_time);
+          if (traces.isEmpty()) {
+            return TimeTraceReport();
+          }
+          return TimeTraceReport::CreateSync(build_folder, traces,
+                                             kTimeTraceEntryCount);
+        });
+    return time_trace_report.Then<int>(
+        this, [this, e, exit_code](TimeTraceReport report) {
+          if (!registry.valid(e) || !registry.all_of<TaskExecution>(e)) {
+            return Promise<int>(exit_code);
+          }
+          registry.remove<RunningBuild>(e);
+          if (!report.IsNull()) {
+            registry.get<TaskExecution>(e).time_trace_report = report;
+            AppendToExecutionOutput(
+                e,
+                "\nTime traces of " + QString::number(report.trace_count) +
+                    " translation units are available in the time trace "
+                    "report\n",
+                false);
+          }
+          return Promise<int>(exit_code);
+        });
+  });
+}
+
+void TaskSystem::TrackBuildProgress(entt::entity e, int first_line,
+                                    int last_line) {
+  auto& exec = registry.get<TaskExecution>(e);
+  for (int i = first_line; i < last_line; i++) {
+    exec.build_progress.ParseLine(exec.output.GetLine(i),
+                                  exec.line_times.GetTime(i));
+  }
+}
+
+void TaskSystem::ReadBuildLogs() {
+  for (entt::entity e : registry.view<RunningBuild>()) {
+    ReadBuildLog(e);
+  }
+}
+
+void TaskSystem::ReadBuildLog(entt::entity e) {
+  auto& build = registry.get<RunningBuild>(e);
+  if (build.reading_log || build.finished) {
+    return;
+  }
+  build.reading_log = true;
+  QString path = build.log_path;
+  qint64 offset = build.log_offset;
+  IoTask::Run<std::pair<QList<NinjaLogEntry>, qint64>>(
+      this,
+      [path, offset]() mutable {
+        QList<NinjaLogEntry> entries = NinjaLog::ReadSync(path, offset);
+        return std::make_pair(entries, offset);
+      },
+      [this, e](std::pair<QList<NinjaLogEntry>, qint64> result) {
+        if (!registry.valid(e) ||
+            !registry.all_of<RunningBuild, TaskExecution>(e)) {
+          return;
+        }
+        auto& build = registry.get<RunningBuild>(e);
+        if (build.finished) {
+          return;
+        }
+        build.log_offset = result.second;
+        build.reading_log = false;
+        build.steps.append(result.first);
+        auto& exec = registry.get<TaskExecution>(e);
+        qint64 threshold = context.slow_build_step_threshold * 1000LL;
+        bool changed = false;
+        for (const NinjaLogEntry& entry : result.first) {
+          if (threshold > 0 && entry.GetDuration() >= threshold) {
+            exec.build_progress.AddSlowStep(entry.output,
+                                            entry.GetDuration());
+            changed = true;
+          }
+        }
+        if (changed) {
+          emit executionBuildProgressChanged(exec.id);
+        }
+      });
+}
+
 Promise<int> TaskSystem::RunProcess(entt::entity e, const QString& exe,
                                     const QStringList& args) {
+  if (registry.all_of<CancelledExecution>(e)) {
+    LOG() << "Not running" << exe << "of a cancelled execution";
+    return Promise<int>(-1);
+  }
   auto promise = QSharedPointer<QPromise<int>>::create();
   auto& p = registry.get<QProcess>(e);
+  // The process might have been run before (e.g. when its task is re-run until
+  // it fails): callbacks of previous runs should not get called again.
+  p.disconnect(this);
   p.setProgram(exe);
   p.setArguments(args);
   QString cmd = exe;
@@ -479,12 +2445,28 @@ Promise<int> TaskSystem::RunProcess(entt::entity e, const QString& exe,
         });
   }
 #endif
-  connect(
-      &p, &QProcess::readyReadStandardError, this,
-      [e, this] { AppendToExecutionOutput(e, true); }, Qt::QueuedConnection);
-  connect(
-      &p, &QProcess::readyReadStandardOutput, this,
-      [e, this] { AppendToExecutionOutput(e, false); }, Qt::QueuedConnection);
+#if __linux__
+  if (context.run_in_pty &&
+      registry.any_of<ExecutableTask, CmakeTargetTask, CmakeBatchBuildTask>(
+          e)) {
+    OpenPty(e);
+  } else {
+    p.setChildProcessModifier({});
+  }
+#endif
+  // Read output as soon as it arrives, to preserve the order in which the
+  // process has written it to stdout and stderr. It will get published to
+  // views in batches.
+  connect(&p, &QProcess::readyReadStandardError, this,
+          [e, this] { ReadProcessOutput(e, true); });
+  connect(&p, &QProcess::readyReadStandardOutput, this,
+          [e, this] { ReadProcessOutput(e, false); });
+  connect(&p, &QProcess::started, this, [e, this] {
+    auto& reaped = registry.emplace_or_replace<ReapedChildrenUsage>(e);
+    reaped.usage = ResourceUsage::GetReapedChildrenUsage();
+    reaped.pid = registry.get<QProcess>(e).processId();
+    reaped.finished_process_count = finished_process_count;
+  });
   connect(
       &p, &QProcess::errorOccurred, this,
       [e, this](QProcess::ProcessError error) {
@@ -497,12 +2479,22 @@ Promise<int> TaskSystem::RunProcess(entt::entity e, const QString& exe,
       Qt::QueuedConnection);
   connect(
       &p, &QProcess::finished, this,
-      [promise](int exit_code, QProcess::ExitStatus) {
+      [promise, e, this](int exit_code, QProcess::ExitStatus) {
+#if __linux__
+        ReadPtyOutput(e);
+#endif
+        FinishResourceUsage(e);
+        PublishExecutionOutput(e);
         promise->addResult(exit_code);
         promise->finish();
       },
       Qt::QueuedConnection);
   p.start();
+#if __linux__
+  if (auto pty = registry.try_get<PtyOutput>(e)) {
+    pty->CloseSlave();
+  }
+#endif
   return promise->future();
 }
 
@@ -524,11 +2516,40 @@ void TaskSystem::Initialize() {
   LOG() << "Initializing";
   context =
       Database::ExecQueryAndReadSync<TaskContext>(
-          "SELECT history_limit, run_with_console_on_win FROM task_context",
+          "SELECT history_limit, run_with_console_on_win, "
+          "output_refresh_interval, output_spill_threshold, run_in_pty, "
+          "output_head_limit, output_tail_limit, job_limit, "
+          "slow_build_step_threshold FROM task_context",
           &TaskSystem::ReadContextFromSql)
           .constFirst();
   LOG() << "Task history limit:" << context.history_limit
-        << "run with console on Windows:" << context.run_with_console_on_win;
+        << "run with console on Windows:" << context.run_with_console_on_win
+        << "output refresh interval:" << context.output_refresh_interval
+        << "output spill threshold:" << context.output_spill_threshold
+        << "run in pseudo-terminal:" << context.run_in_pty
+        << "output head limit:" << context.output_head_limit
+        << "output tail limit:" << context.output_tail_limit
+        << "job limit:" << context.job_limit
+        << "slow build step threshold:" << context.slow_build_step_threshold;
+  // Output files and pieces of executions, that were removed from the
+  // database without us knowing (e.g. together with their project) or that
+  // were never finished, are no longer needed.
+  IoTask::Run([] {
+    RemoveUnusedOutputPiecesSync();
+    RemoveOrphanedOutputFilesSync();
+  });
+#if __linux__
+  auto resource_usage_timer = new QTimer(this);
+  connect(resource_usage_timer, &QTimer::timeout, this,
+          &TaskSystem::SampleResourceUsage);
+  resource_usage_timer->start(1000);
+#endif
+  connect(&file_watcher, &FileWatcher::filesChanged, this,
+          &TaskSystem::RerunWatchedTask);
+  auto build_log_timer = new QTimer(this);
+  connect(build_log_timer, &QTimer::timeout, this,
+          &TaskSystem::ReadBuildLogs);
+  build_log_timer->start(1000);
 }
 
 const TaskExecution& TaskSystem::GetLastExecution() const {
@@ -536,5 +2557,19 @@ const TaskExecution& TaskSystem::GetLastExecution() const {
 }
 
 TaskId CmakeTask::GetId() const {
-  return "cmake:" + source_path + ':' + build_path;
+  TaskId id = "cmake:" + source_path + ':' + build_path;
+  if (profile) {
+    id += ":profile";
+  }
+  return id;
+}
+
+TaskId CmakeTargetTask::GetId() const {
+  return "cmake-target:" + target_name + ':' + executable + ':' +
+         build_folder + ':' + QString::number(run_after_build);
+}
+
+TaskId CmakeBatchBuildTask::GetId() const {
+  return "cmake-batch:" + build_folder + ':' + target_names.join(',') + ':' +
+         QString::number(jobs);
 }
@@ -11,14 +11,51 @@
 #include <entt.hpp>
 #include <optional>
 
+#include "allocation_profile.h"
+#include "build_progress.h"
+#include "cmake_profile.h"
+#include "cpu_profile.h"
+#include "file_watcher.h"
+#include "interval_set.h"
+#include "line_times.h"
+#include "perf_counters.h"
 #include "promise.h"
+#include "resource_usage.h"
+#include "text_buffer.h"
+#include "time_trace_report.h"
 #include "ui_icon.h"
 
 typedef QString TaskId;
 
+// Tool, that an executable of a task gets run under, to profile it.
+enum class Profiler {
+  kNone,
+  // Samples call stacks of the executable with "perf record".
+  kSampling,
+  // Counts hardware events of the executable with "perf stat".
+  kCounters,
+  // Counts heap allocations of the executable with the allocation profiler
+  // library, that gets preloaded into it.
+  kAllocations,
+};
+
+// Way of running several processes of an executable of a task at the same
+// time.
+enum class ParallelMode {
+  kNone,
+  // Copies of the executable keep running until one of them fails.
+  kStress,
+  // Google Test executable, that splits its tests into shards by itself.
+  kGtestShards,
+  // QtTest executable, batches of test functions of which are run by separate
+  // processes.
+  kQtestFunctions,
+};
+
 struct ExecutableTask {
   QString path;
   QStringList args;
+  Profiler profiler = Profiler::kNone;
 };
 
 struct CmakeTask {
@@ -26,14 +63,57 @@ struct CmakeTask {
 
   QString source_path;
   QString build_path;
+  // Makes CMake write a trace of the configure, which then gets parsed into
+  // a profile of it.
+  bool profile = false;
 };
 
 struct CmakeTargetTask {
+  TaskId GetId() const;
+
   QString build_folder;
   QString target_name;
   QString executable;
   QStringList executable_args;
   bool run_after_build = false;
+  // Only used, when the executable is run after the build.
+  Profiler profiler = Profiler::kNone;
+};
+
+// Several CMake targets, that get built by a single invocation of the build
+// tool, which loads the build graph once and builds the targets in parallel.
+struct CmakeBatchBuildTask {
+  TaskId GetId() const;
+
+  QString build_folder;
+  QStringList target_names;
+  // Number of parallel jobs of the build tool. Job limit is used when it is
+  // not specified.
+  int jobs = 0;
+};
+
+// Several tasks, that depend on each other. A step gets executed once all the
+// steps, that it should run after, have succeeded, so independent steps get
+// executed in parallel.
+// Megabytes of output of an execution, that are kept from its start (head)
+// and from its end (tail). Limits, that are 0, are disabled.
+struct OutputLimits {
+  int head = 0;
+  int tail = 0;
+};
+
+struct PipelineTask {
+  struct Step {
+    QString name;
+    QStringList after;
+    TaskId task_id;
+    QByteArray task_data;
+    // Steps, that don't have limits of their own, use the ones from settings.
+    std::optional<OutputLimits> output_limits;
+  };
+
+  QString name;
+  QList<Step> steps;
 };
 
 struct TaskExecution {
@@ -43,8 +123,22 @@ struct TaskExecution {
   QString task_name;
   QByteArray task_data;
   std::optional<int> exit_code;
-  QSet<int> stderr_line_indices;
-  QString output;
+  IntervalSet stderr_line_indices;
+  TextBuffer output;
+  LineTimes line_times;
+  qint64 elided_size = 0;
+  qint64 elided_line_count = 0;
+  ResourceUsage resource_usage;
+  // Only tracked while the execution is running.
+  BuildProgress build_progress;
+  // Aggregated -ftime-trace traces of a build, if it has produced any.
+  TimeTraceReport time_trace_report;
+  // Profile of a CMake configure, if it has been run with profiling.
+  CmakeProfile cmake_profile;
+  // Call stacks of a profiled executable.
+  CpuProfile cpu_profile;
+  PerfCounters perf_counters;
+  AllocationProfile allocation_profile;
 
   bool IsNull() const;
   UiIcon GetStatusAsIcon() const;
@@ -52,9 +146,27 @@ struct TaskExecution {
   bool operator!=(const TaskExecution& another) const;
 };
 
+// Task, that gets re-run each time files of the project change.
+struct WatchedTask {
+  TaskId task_id;
+  QByteArray task_data;
+  // Latest run of the task and its execution.
+  entt::entity run = entt::null;
+  QUuid execution_id;
+  // Set when files change while the latest run is still in progress.
+  bool rerun_pending = false;
+};
+
 struct TaskContext {
   int history_limit;
   bool run_with_console_on_win;
+  int output_refresh_interval;
+  int output_spill_threshold;
+  bool run_in_pty;
+  int output_head_limit;
+  int output_tail_limit;
+  int job_limit;
+  int slow_build_step_threshold;
 };
 
 class TaskSystem : public QObject {
@@ -65,19 +177,45 @@ class TaskSystem : public QObject {
   static TaskContext ReadContextFromSql(QSqlQuery& sql);
   static void CreateCmakeQueryFilesSync(const QString& path);
   static QString GetTaskName(const entt::registry& registry, entt::entity e);
+  static QString GetOutputFolder();
+  static QStringList ListQtestFunctionsSync(const ExecutableTask& task);
+  static void RemoveExecutionsSync(const QString& condition,
+                                   const QVariantList& args);
+  static void WriteOutputPiecesSync(QUuid exec_id, const TextBuffer& output);
+  static void RemoveUnusedOutputPiecesSync();
+  static void RemoveOrphanedOutputFilesSync();
+  static void EmplaceTask(entt::registry& registry, entt::entity e,
+                          const TaskId& id, const QByteArray& task_data,
+                          const QStringList& executable_args = {});
 
   template <typename T>
   void RunTask(const TaskId& id, T t, bool repeat_until_fail,
-               const QString& view) {
+               const QString& view,
+               ParallelMode parallel = ParallelMode::kNone) {
+    entt::entity e = registry.create();
+    registry.emplace<TaskId>(e, id);
+    registry.emplace<T>(e, t);
+    if (!repeat_until_fail && parallel == ParallelMode::kNone &&
+        CoalesceWithRunningTask(e, view)) {
+      return;
+    }
+    RunExecution(e, repeat_until_fail, view, parallel);
+  }
+
+  template <typename T>
+  void RunTaskOnChanges(const TaskId& id, T t, const QString& view) {
     entt::entity e = registry.create();
     registry.emplace<TaskId>(e, id);
     registry.emplace<T>(e, t);
-    RunExecution(e, repeat_until_fail, view);
+    WatchTask(e, view);
   }
 
   void RunTaskOfExecution(const TaskExecution& exec, bool repeat_until_fail,
                           const QString& view,
                           const QStringList& executable_args = {});
+  void RunTaskOfExecutionOnChanges(const TaskExecution& exec,
+                                   const QString& view);
+  void RunPipeline(const TaskId& id, const PipelineTask& pipeline);
   void KillAllTasks();
   void LoadLastTaskExecution();
   void ClearLastTaskExecution();
@@ -85,6 +223,10 @@ class TaskSystem : public QObject {
   Promise<QList<TaskExecution>> FetchExecutions(QUuid project_id) const;
   Promise<TaskExecution> FetchExecution(QUuid execution_id,
                                         bool include_output) const;
+  Promise<TimeTraceReport> FetchTimeTraceReport(QUuid execution_id) const;
+  Promise<CmakeProfile> FetchCmakeProfile(QUuid execution_id) const;
+  Promise<CpuProfile> FetchCpuProfile(QUuid execution_id) const;
+  Promise<AllocationProfile> FetchAllocationProfile(QUuid execution_id) const;
   QList<TaskExecution> GetActiveExecutions() const;
   QString GetCurrentTaskName() const;
   void SetSelectedExecutionId(QUuid id);
@@ -96,29 +238,96 @@ class TaskSystem : public QObject {
 
  public slots:
   void cancelSelectedExecution(bool forcefully);
+  void stopWatchingTask();
 
  signals:
-  void executionOutputChanged(QUuid exec_id);
+  // Emitted each time a running execution receives new output, that replaces
+  // its output starting from start_offset. Each of stderr_ranges is an
+  // inclusive range of indices of lines, that have been printed to stderr.
+  // line_times are arrival times of lines starting from the one, that
+  // contains start_offset.
+  void executionOutputAppended(QUuid exec_id, int start_offset,
+                               const QString& data,
+                               const QList<std::pair<int, int>>& stderr_ranges,
+                               const LineTimes& line_times);
   void executionFinished(QUuid exec_id);
+  void executionResourceUsageChanged(QUuid exec_id);
+  void executionBuildProgressChanged(QUuid exec_id);
   void currentTaskChanged();
   void selectedExecutionChanged();
 
  private:
   void RunExecution(entt::entity e, bool repeat_until_fail,
-                    const QString& view);
+                    const QString& view,
+                    ParallelMode parallel = ParallelMode::kNone);
+  entt::entity FindRunningTask(entt::entity e) const;
+  bool CoalesceWithRunningTask(entt::entity e, const QString& view);
+  void WatchTask(entt::entity e, const QString& view);
+  void RerunWatchedTask();
+  void CancelExecution(entt::entity e, bool forcefully);
+  void ScheduleTasks();
+  void FinishPipelineStep(entt::entity step, int exit_code);
   Promise<int> RunTask(entt::entity e);
   Promise<int> RunTaskUntilFail(entt::entity e);
+  Promise<int> RunTaskInParallel(entt::entity e, ParallelMode parallel);
+  Promise<int> StartQtestRun(entt::entity e, const ExecutableTask& task);
+  Promise<int> StartShardedRun(entt::entity e, const ExecutableTask& task,
+                               const QList<QStringList>& batches = {});
+  void RunShard(entt::entity worker);
+  void ForwardShardOutput(entt::entity worker, const QString& data,
+                          bool is_stderr, bool flush);
+  void FinishShard(entt::entity worker, int exit_code);
+  void StopShardedRun(entt::entity e);
+  Promise<int> StartStressRun(entt::entity e, const ExecutableTask& task);
+  void RunStressIteration(entt::entity worker);
+  void FinishStressIteration(entt::entity worker, int exit_code);
+  void StopStressRun(entt::entity e);
+  void FinishStressRun(entt::entity e);
+  void ResetExecutionOutput(entt::entity e);
   Promise<int> RunExecutableTask(entt::entity e);
   Promise<int> RunCmakeTask(entt::entity e);
+  Promise<int> FinishCmakeTask(entt::entity e, int exit_code,
+                               const QString& trace_path);
   Promise<int> RunCmakeTargetTask(entt::entity e);
+  Promise<int> RunCmakeBatchBuildTask(entt::entity e);
+  Promise<int> RunCmakeBuild(entt::entity e, const QString& build_folder,
+                             const QStringList& args);
+  Promise<int> FinishBuild(entt::entity e, int exit_code);
+  void TrackBuildProgress(entt::entity e, int first_line, int last_line);
+  void ReadBuildLog(entt::entity e);
+  void ReadBuildLogs();
+  void TrackBatchBuildTargets(entt::entity e, int first_line, int last_line);
+  Promise<int> RunProfiledProcess(entt::entity e, const QString& exe,
+                                  const QStringList& args, Profiler profiler);
+  Promise<int> FinishSamplingProfile(entt::entity e, int exit_code,
+                                     const QString& data_path);
+  Promise<int> FinishCounters(entt::entity e, int exit_code,
+                              const QString& data_path);
+  Promise<int> FinishAllocationProfile(entt::entity e, int exit_code,
+                                       const QString& data_path);
   Promise<int> RunProcess(entt::entity e, const QString& exe,
                           const QStringList& args = {});
-  void AppendToExecutionOutput(entt::entity entity, bool is_stderr);
-  void AppendToExecutionOutput(entt::entity entity, QString data,
+  void ReadProcessOutput(entt::entity entity, bool is_stderr);
+  void AppendToExecutionOutput(entt::entity entity, const QString& data,
                                bool is_stderr);
+  void PublishExecutionOutput(entt::entity entity);
+  int ElideExecutionOutput(entt::entity entity);
+#if __linux__
+  void OpenPty(entt::entity entity);
+  void ReadPtyOutput(entt::entity entity);
+#endif
   void FinishExecution(entt::entity entity, int exit_code);
+  void SampleResourceUsage();
+  void UpdateResourceUsage(
+      const QList<std::pair<entt::entity, qint64>>& processes,
+      const QList<ResourceUsage>& usages);
+  void FinishResourceUsage(entt::entity entity);
+  entt::entity GetResourceUsageOwner(entt::entity entity) const;
 
   entt::registry registry;
   QUuid selected_execution_id;
   TaskExecution last_execution;
+  FileWatcher file_watcher;
+  std::optional<WatchedTask> watched_task;
+  int finished_process_count = 0;
 };
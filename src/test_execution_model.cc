@@ -86,50 +86,61 @@ QString TestExecutionModel::GetProgressBarColor() const {
   return success ? kTheme.kColorGreen : "red";
 }
 
-void TestExecutionModel::StartTest(const QString& test_suite,
-                                   const QString& test_case,
-                                   const QString& rerun_id) {
+int TestExecutionModel::StartTest(const QString& test_suite,
+                                  const QString& test_case,
+                                  const QString& rerun_id) {
   FinishTestPreparationIfNecessary(true);
   LOG() << "New test started:" << test_suite << test_case << rerun_id;
   Test test;
   test.test_suite = test_suite;
   test.test_case = test_case;
   test.rerun_id = rerun_id;
-  last_test_start = std::chrono::system_clock::now();
+  test.start_time = std::chrono::system_clock::now();
   tests.append(test);
   emit statusChanged();
+  return tests.size() - 1;
 }
 
-void TestExecutionModel::AppendOutputToCurrentTest(const QString& output) {
-  Q_ASSERT(!tests.isEmpty());
-  Test& test = tests.last();
+void TestExecutionModel::AppendOutputToTest(int i, const QString& output) {
+  Q_ASSERT(i >= 0 && i < tests.size());
+  Test& test = tests[i];
   LOG() << "Output added to" << test.test_suite << test.test_case;
   test.output += output;
-  if (tests.size() - 1 == GetSelectedItemIndex()) {
-    emit selectedTestOutputChanged();
+  if (i == GetSelectedItemIndex()) {
+    emit selectedTestOutputAppended(output);
   }
 }
 
+void TestExecutionModel::AppendOutputToCurrentTest(const QString& output) {
+  AppendOutputToTest(tests.size() - 1, output);
+}
+
 void TestExecutionModel::AppendTestPreparationOutput(const QString& output) {
   if (tests.isEmpty()) {
     StartTest("", "Before Tests Start", "");
     has_preparation_test = true;
   }
-  AppendOutputToCurrentTest(output);
+  // Output, that is not specific to any of the tests, can also arrive after
+  // they start (e.g. when they are run in shards).
+  AppendOutputToTest(has_preparation_test ? 0 : tests.size() - 1, output);
 }
 
-void TestExecutionModel::FinishCurrentTest(bool success) {
-  Q_ASSERT(!tests.isEmpty());
-  Test& test = tests.last();
+void TestExecutionModel::FinishTest(int i, bool success) {
+  Q_ASSERT(i >= 0 && i < tests.size());
+  Test& test = tests[i];
   Q_ASSERT(test.status == TestStatus::kRunning);
   LOG() << "Test finished:" << test.test_suite << test.test_case
         << "success:" << success;
   test.status = success ? TestStatus::kCompleted : TestStatus::kFailed;
   test.duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-      std::chrono::system_clock::now() - last_test_start);
+      std::chrono::system_clock::now() - test.start_time);
   emit statusChanged();
 }
 
+void TestExecutionModel::FinishCurrentTest(bool success) {
+  FinishTest(tests.size() - 1, success);
+}
+
 void TestExecutionModel::SetTestCount(int count) {
   if (count < 0) {
     count = GetCurrentTestCount();
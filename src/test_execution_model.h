@@ -19,6 +19,7 @@ struct Test {
   QString rerun_id;
   TestStatus status = TestStatus::kRunning;
   std::chrono::milliseconds duration = std::chrono::milliseconds(0);
+  std::chrono::system_clock::time_point start_time;
 };
 
 class TestExecutionModel : public TextListModel {
@@ -38,10 +39,12 @@ class TestExecutionModel : public TextListModel {
   QString GetStatus() const;
   float GetProgress() const;
   QString GetProgressBarColor() const;
-  void StartTest(const QString& test_suite, const QString& test_case,
-                 const QString& rerun_id);
+  int StartTest(const QString& test_suite, const QString& test_case,
+                const QString& rerun_id);
+  void AppendOutputToTest(int i, const QString& output);
   void AppendOutputToCurrentTest(const QString& output);
   void AppendTestPreparationOutput(const QString& output);
+  void FinishTest(int i, bool success);
   void FinishCurrentTest(bool success);
   void SetTestCount(int count);
   bool IsSelectedTestRerunnable() const;
@@ -56,6 +59,7 @@ class TestExecutionModel : public TextListModel {
 
  signals:
   void selectedTestOutputChanged();
+  void selectedTestOutputAppended(const QString& output);
   void statusChanged();
   void rerunTest(const QString& id, bool repeat_until_fail);
 
@@ -63,7 +67,6 @@ class TestExecutionModel : public TextListModel {
   void FinishTestPreparationIfNecessary(bool success);
   int GetCurrentTestCount() const;
 
-  std::chrono::system_clock::time_point last_test_start;
   QList<Test> tests;
   int test_count;
   bool has_preparation_test;
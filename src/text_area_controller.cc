@@ -3,94 +3,117 @@
 #include <QClipboard>
 #include <QFontMetrics>
 #include <QGuiApplication>
+#include <QtConcurrent>
 #include <algorithm>
 #include <cmath>
 #include <limits>
 
 #include "application.h"
+#include "promise.h"
 #include "theme.h"
 
 BigTextAreaModel::BigTextAreaModel(QObject* parent)
     : QAbstractListModel(parent),
       cursor_follow_end(false),
       cursor_position(-1),
+      text_is_shared(false),
       selection_formatter(new SelectionFormatter(this, selection)) {
   connect(this, &BigTextAreaModel::cursorPositionChanged, this, [this] {
     if (cursor_position >= 0) {
-      emit goToLine(GetLineWithOffset(cursor_position));
+      emit goToLine(text.GetLineWithOffset(cursor_position));
     }
   });
 }
 
 QHash<int, QByteArray> BigTextAreaModel::roleNames() const {
-  return {{0, "text"}, {1, "offset"}};
+  return {{0, "text"}, {1, "offset"}, {2, "timeGap"}};
 }
 
 int BigTextAreaModel::rowCount(const QModelIndex&) const {
-  return line_start_offsets.size();
+  return text.GetLineCount();
 }
 
 QVariant BigTextAreaModel::data(const QModelIndex& index, int role) const {
   if (role == 0) {
-    int start = line_start_offsets[index.row()];
-    int length = GetLineLength(index.row());
-    return text.sliced(start, length);
+    return text.GetLine(index.row());
   } else if (role == 1) {
-    return line_start_offsets[index.row()];
+    return text.GetLineOffset(index.row());
+  } else if (role == 2) {
+    qint64 gap = line_times.GetGap(index.row());
+    if (gap <= 0) {
+      return QString();
+    } else if (gap < 1000) {
+      return '+' + QString::number(gap) + "ms";
+    } else {
+      return '+' + QString::number(gap / 1000.0, 'f', 1) + 's';
+    }
   } else {
     return QVariant();
   }
 }
 
 void BigTextAreaModel::SetText(const QString& text) {
-  bool is_append = !this->text.isEmpty() && text.startsWith(this->text);
-  int first_new_line = 0;
-  if (is_append) {
-    first_new_line = line_start_offsets.constLast();
-    beginRemoveRows(QModelIndex(), line_start_offsets.size() - 1,
-                    line_start_offsets.size() - 1);
-    line_start_offsets.removeLast();
-    endRemoveRows();
-  } else if (!line_start_offsets.isEmpty()) {
-    beginRemoveRows(QModelIndex(), 0, line_start_offsets.size() - 1);
-    line_start_offsets.clear();
-    selection = TextSelection();
-    endRemoveRows();
-  }
-  QList<int> new_lines;
-  if (!text.isEmpty()) {
-    new_lines.append(first_new_line);
-  }
-  int pos = is_append ? this->text.size() : 0;
-  while (true) {
-    int i = text.indexOf('\n', pos);
-    if (i < 0) {
-      break;
-    }
-    new_lines.append(i + 1);
-    pos = new_lines.constLast();
-  }
-  this->text = text;
-  if (new_lines.isEmpty()) {
-    return;
+  ResetText();
+  appendText(text);
+}
+
+QString BigTextAreaModel::GetText() const { return text.GetText(); }
+
+void BigTextAreaModel::SetBuffer(const QVariant& buffer) {
+  // Buffers, that are snapshots of the same text, are displayed without
+  // copying it, which matters when it is memory-mapped from disk.
+  auto new_text = buffer.value<TextBuffer>();
+  if (!text.IsContinuedBy(new_text)) {
+    ResetText();
   }
-  beginInsertRows(QModelIndex(), line_start_offsets.size(),
-                  line_start_offsets.size() + new_lines.size() - 1);
-  line_start_offsets.append(new_lines);
-  endInsertRows();
-  emit textChanged();
-  if (cursor_follow_end) {
-    emit goToLine(line_start_offsets.size() - 1);
-  } else if (cursor_position >= 0) {
-    emit goToLine(GetLineWithOffset(cursor_position));
+  ExtendText(new_text);
+  text_is_shared = true;
+}
+
+QVariant BigTextAreaModel::GetBuffer() const {
+  return QVariant::fromValue(text);
+}
+
+void BigTextAreaModel::SetLineTimes(const QVariant& line_times) {
+  this->line_times = line_times.value<LineTimes>();
+  if (rowCount(QModelIndex()) > 0) {
+    emit dataChanged(index(0), index(rowCount(QModelIndex()) - 1), {2});
   }
+  emit lineTimesChanged();
 }
 
-QString BigTextAreaModel::GetText() const { return text; }
+QVariant BigTextAreaModel::GetLineTimes() const {
+  return QVariant::fromValue(line_times);
+}
 
 int BigTextAreaModel::GetLineNumberMaxWidth() const {
   QFontMetrics m(font);
-  return m.horizontalAdvance(QString::number(line_start_offsets.size()));
+  return m.horizontalAdvance(QString::number(text.GetLineCount()));
+}
+
+void BigTextAreaModel::appendText(const QString& text) {
+  if (text.isEmpty()) {
+    return;
+  }
+  // Appending to a buffer, that is shared with its owner, would write into
+  // the owner's storage.
+  if (text_is_shared) {
+    this->text = this->text.Detached();
+    text_is_shared = false;
+  }
+  TextBuffer extended = this->text;
+  extended.Append(text);
+  ExtendText(extended);
+}
+
+void BigTextAreaModel::appendLineTimes(int first_line,
+                                       const QVariant& line_times) {
+  this->line_times.Replace(first_line, line_times.value<LineTimes>());
+  int last_line =
+      std::min(this->line_times.GetCount(), rowCount(QModelIndex())) - 1;
+  if (first_line <= last_line) {
+    emit dataChanged(index(first_line), index(last_line), {2});
+  }
 }
 
 void BigTextAreaModel::selectInline(int line, int start, int end) {
@@ -99,19 +122,19 @@ void BigTextAreaModel::selectInline(int line, int start, int end) {
 }
 
 void BigTextAreaModel::selectLine(int line) {
-  selection.SelectLine(line, line_start_offsets.size(),
+  selection.SelectLine(line, text.GetLineCount(),
                        [this](int a, int b) { emit rehighlightLines(a, b); });
 }
 
 void BigTextAreaModel::selectAll() {
-  selection.SelectAll(line_start_offsets.size(),
+  selection.SelectAll(text.GetLineCount(),
                       [this](int a, int b) { emit rehighlightLines(a, b); });
 }
 
 void BigTextAreaModel::selectSearchResult(int offset, int length) {
   if (length > 0) {
-    int line = GetLineWithOffset(offset);
-    int line_offset = offset - line_start_offsets[line];
+    int line = text.GetLineWithOffset(offset);
+    int line_offset = offset - text.GetLineOffset(line);
     selectInline(line, line_offset, line_offset + length);
     emit goToLine(line);
   } else {
@@ -127,12 +150,12 @@ void BigTextAreaModel::copySelection(int current_line) {
   TextSelection s = selection.Normalize();
   std::pair<int, int> range;
   if (s.first_line < 0) {
-    int start = line_start_offsets[current_line];
-    range = std::make_pair(start, start + GetLineLength(current_line));
+    int start = text.GetLineOffset(current_line);
+    range = std::make_pair(start, start + text.GetLineLength(current_line));
   } else {
     range = GetSelectionRange(s);
   }
-  QString text = this->text.sliced(range.first, range.second - range.first);
+  QString text = this->text.GetText(range.first, range.second - range.first);
   QGuiApplication::clipboard()->setText(text);
 }
 
@@ -141,7 +164,7 @@ int BigTextAreaModel::getSelectionOffset() {
   if (s.first_line < 0) {
     return -1;
   }
-  return line_start_offsets[s.first_line] + std::max(s.first_line_offset, 0);
+  return text.GetLineOffset(s.first_line) + std::max(s.first_line_offset, 0);
 }
 
 QString BigTextAreaModel::getSelectedText() {
@@ -150,31 +173,64 @@ QString BigTextAreaModel::getSelectedText() {
     return "";
   }
   std::pair<int, int> range = GetSelectionRange(s);
-  return text.sliced(range.first, range.second - range.first);
+  return text.GetText(range.first, range.second - range.first);
 }
 
 void BigTextAreaModel::rehighlight() {
-  emit rehighlightLines(0, line_start_offsets.size());
+  emit rehighlightLines(0, text.GetLineCount());
 }
 
-int BigTextAreaModel::GetLineLength(int line) const {
-  if (line < 0 || line >= line_start_offsets.size()) {
-    return 0;
+void BigTextAreaModel::goToLargestTimeGap() {
+  int line = line_times.FindLargestGap();
+  if (line >= 0) {
+    emit goToLine(line);
   }
-  int start = line_start_offsets[line];
-  int end = line < line_start_offsets.size() - 1
-                ? line_start_offsets[line + 1] - 1
-                : text.size();
-  return std::max(end - start, 0);
 }
 
-int BigTextAreaModel::GetLineWithOffset(int offset) const {
-  for (int i = 0; i < line_start_offsets.size(); i++) {
-    if (offset < line_start_offsets[i]) {
-      return i - 1;
-    }
+void BigTextAreaModel::ResetText() {
+  text_is_shared = false;
+  if (text.IsEmpty()) {
+    text.Clear();
+    return;
+  }
+  beginRemoveRows(QModelIndex(), 0, text.GetLineCount() - 1);
+  text.Clear();
+  selection = TextSelection();
+  endRemoveRows();
+  emit textExtended(0);
+}
+
+void BigTextAreaModel::ExtendText(const TextBuffer& extended) {
+  int old_line_count = text.GetLineCount();
+  int last_line = old_line_count - 1;
+  if (extended.GetSize() == text.GetSize() &&
+      extended.GetLine(last_line) == text.GetLine(last_line)) {
+    text = extended;
+    return;
+  }
+  // The last line of the current text gets extended (or overwritten) by the
+  // first line of the appended text, while the rest of the appended lines
+  // become new rows.
+  int new_line_count = extended.GetLineCount();
+  int changed_offset = text.GetLineOffset(last_line);
+  if (new_line_count > old_line_count) {
+    beginInsertRows(QModelIndex(), old_line_count, new_line_count - 1);
+  }
+  text = extended;
+  if (new_line_count > old_line_count) {
+    endInsertRows();
+  }
+  if (old_line_count > 0) {
+    QModelIndex i = index(old_line_count - 1);
+    emit dataChanged(i, i);
+  }
+  emit textChanged();
+  emit textExtended(changed_offset);
+  if (cursor_follow_end) {
+    emit goToLine(text.GetLineCount() - 1);
+  } else if (cursor_position >= 0) {
+    emit goToLine(text.GetLineWithOffset(cursor_position));
   }
-  return 0;
 }
 
 LineHighlighter::LineHighlighter(QObject* parent)
@@ -309,15 +365,15 @@ bool TextSelection::Reset(const std::function<void(int, int)>& rehighlight) {
 
 std::pair<int, int> BigTextAreaModel::GetSelectionRange(
     const TextSelection& s) const {
-  int start = line_start_offsets[s.first_line];
-  int end = line_start_offsets[s.last_line];
+  int start = text.GetLineOffset(s.first_line);
+  int end = text.GetLineOffset(s.last_line);
   if (s.first_line_offset >= 0) {
     start += s.first_line_offset;
   }
   if (s.last_line_offset >= 0) {
     end += s.last_line_offset;
   } else {
-    end += GetLineLength(s.last_line);
+    end += text.GetLineLength(s.last_line);
   }
   return std::make_pair(start, end);
 }
@@ -338,7 +394,7 @@ QString TextSearchController::GetSearchResultsCount() const {
   }
 }
 
-void TextSearchController::search(const QString& term, const QString& text,
+void TextSearchController::search(const QString& term, const QVariant& text,
                                   bool select_result,
                                   bool notify_results_changed) {
   int prev_start = -1;
@@ -347,22 +403,12 @@ void TextSearchController::search(const QString& term, const QString& text,
   }
   results.clear();
   index.clear();
-  if (term.size() > 2) {
-    int line = 0;
-    int pos = 0;
-    while (true) {
-      int i = text.indexOf(term, pos, Qt::CaseSensitivity::CaseInsensitive);
-      if (i < 0) {
-        break;
-      }
-      line += text.sliced(pos, i - pos).count('\n');
-      index[line].append(results.size());
-      TextSegment result;
-      result.offset = i;
-      result.length = term.size();
-      results.append(result);
-      pos = result.offset + result.length;
-    }
+  if (text.canConvert<TextBuffer>()) {
+    Search(term, text.value<TextBuffer>(), 0);
+  } else {
+    TextBuffer buffer;
+    buffer.Append(text.toString());
+    Search(term, buffer, 0);
   }
   if (notify_results_changed) {
     emit searchResultsChanged();
@@ -387,6 +433,29 @@ void TextSearchController::search(const QString& term, const QString& text,
   emit searchResultsCountChanged();
 }
 
+void TextSearchController::searchAppended(const QString& term,
+                                          const QVariant& text, int offset) {
+  auto buffer = text.value<TextBuffer>();
+  // Results, that have been found in the changed line, might be gone.
+  int line = buffer.GetLineWithOffset(offset);
+  int count = results.size();
+  while (!results.isEmpty() && results.constLast().offset >= offset) {
+    results.removeLast();
+  }
+  if (results.isEmpty()) {
+    index.clear();
+  } else {
+    index.remove(line);
+  }
+  Search(term, buffer, offset);
+  if (selected_result >= results.size()) {
+    selected_result = 0;
+  }
+  if (results.size() != count) {
+    emit searchResultsCountChanged();
+  }
+}
+
 void TextSearchController::replaceSearchResultWith(const QString& text,
                                                    bool replace_all) {
   if (results.isEmpty()) {
@@ -436,6 +505,44 @@ void TextSearchController::DisplaySelectedSearchResult() {
   emit selectResult(result.offset, result.length);
 }
 
+void TextSearchController::Search(const QString& term, const TextBuffer& text,
+                                  int offset) {
+  if (term.size() <= 2) {
+    return;
+  }
+  // Go through the text piece by piece instead of copying all of it at once:
+  // it can be memory-mapped from a huge file. Pieces end at line breaks, so
+  // that results don't get cut in half, unless a line doesn't fit into one.
+  int line = text.GetLineWithOffset(offset);
+  int pos = 0;
+  while (offset < text.GetSize()) {
+    QString piece = text.GetText(offset, TextBuffer::kChunkSize);
+    int end = piece.size();
+    if (offset + end < text.GetSize()) {
+      int i = piece.lastIndexOf('\n');
+      end = i >= 0 ? i + 1 : std::max(end - static_cast<int>(term.size()), 1);
+    }
+    int counted = 0;
+    while (true) {
+      int i = piece.indexOf(term, pos, Qt::CaseSensitivity::CaseInsensitive);
+      if (i < 0 || i >= end) {
+        break;
+      }
+      line += QStringView(piece).sliced(counted, i - counted).count('\n');
+      counted = i;
+      index[line].append(results.size());
+      TextSegment result;
+      result.offset = offset + i;
+      result.length = term.size();
+      results.append(result);
+      pos = i + result.length;
+    }
+    line += QStringView(piece).sliced(counted, end - counted).count('\n');
+    offset += end;
+    pos = std::max(pos - end, 0);
+  }
+}
+
 SearchFormatter::SearchFormatter(QObject* parent,
                                  const QList<TextSegment>& results,
                                  const QHash<int, QList<int>>& index)
@@ -520,14 +627,28 @@ QList<TextFormat> FileLinkFormatter::Format(const QString&,
   return fs;
 }
 
-FileLinkLookupController::FileLinkLookupController(QObject* parent)
-    : QObject(parent),
-      current_line(0),
-      current_line_link(0),
-      formatter(new FileLinkFormatter(this, links, index, current_line,
-                                      current_line_link)) {}
+static void FindFileLinks(const QRegularExpression& regex, const QString& text,
+                          const FileLinks& links, QList<FileLink>& found) {
+  int line = links.last_line;
+  int pos = 0;
+  for (auto it = regex.globalMatch(text); it.hasNext();) {
+    QRegularExpressionMatch m = it.next();
+    FileLink link;
+    link.file_path = m.captured(1);
+    link.offset = links.last_line_offset + m.capturedStart();
+    link.length = m.capturedLength();
+    link.line_num = m.captured(2).toInt();
+    if (m.lastCapturedIndex() > 2) {
+      link.col_num = m.captured(3).toInt();
+    }
+    line += text.sliced(pos, m.capturedStart() - pos).count('\n');
+    link.line = line;
+    pos = m.capturedStart();
+    found.append(link);
+  }
+}
 
-void FileLinkLookupController::findFileLinks(const QString& text) {
+static void FindFileLinks(const QString& text, FileLinks& links) {
   static const QRegularExpression kUnix1(
       "([A-Z]?\\:?\\/[^:\\n]+):([0-9]+):?([0-9]+)?");
   static const QRegularExpression kUnix2(
@@ -536,12 +657,111 @@ void FileLinkLookupController::findFileLinks(const QString& text) {
       "([A-Z]\\:\\\\[^:\\n]+)\\(([0-9]+),?([0-9]+)?\\)");
   static const QRegularExpression kWin2(
       "([A-Z]\\:\\\\[^:\\n]+):([0-9]+):([0-9]+)?");
-  links.clear();
-  index.clear();
-  FindFileLinks(kUnix1, text);
-  FindFileLinks(kUnix2, text);
-  FindFileLinks(kWin1, text);
-  FindFileLinks(kWin2, text);
+  QList<FileLink> found;
+  FindFileLinks(kUnix1, text, links, found);
+  FindFileLinks(kUnix2, text, links, found);
+  FindFileLinks(kWin1, text, links, found);
+  FindFileLinks(kWin2, text, links, found);
+  // Keep links ordered by their position in text so that links of the last
+  // line are always at the end of the list.
+  std::sort(found.begin(), found.end(),
+            [](const FileLink& a, const FileLink& b) {
+              return a.offset < b.offset;
+            });
+  for (const FileLink& link : found) {
+    links.index[link.line].append(links.links.size());
+    links.links.append(link);
+  }
+  int i = text.lastIndexOf('\n');
+  links.last_line += text.count('\n');
+  links.last_line_offset += i + 1;
+  links.last_line_text = text.sliced(i + 1);
+}
+
+static void FindFileLinksInAppendedText(const QString& text,
+                                        FileLinks& links) {
+  // The last line of the text, that we have seen so far, might continue in
+  // the appended text, so links found in it should be looked up again.
+  while (!links.links.isEmpty() &&
+         links.links.constLast().line == links.last_line) {
+    links.links.removeLast();
+  }
+  links.index.remove(links.last_line);
+  FindFileLinks(links.last_line_text + text, links);
+}
+
+static void FindFileLinksInWrittenText(int offset, const QString& text,
+                                       FileLinks& links) {
+  // Only the last line can get overwritten.
+  int pos = std::clamp(offset - links.last_line_offset, 0,
+                       static_cast<int>(links.last_line_text.size()));
+  links.last_line_text.truncate(pos);
+  FindFileLinksInAppendedText(text, links);
+}
+
+FileLinkLookupController::FileLinkLookupController(QObject* parent)
+    : QObject(parent),
+      current_line(0),
+      current_line_link(0),
+      formatter(new FileLinkFormatter(this, file_links.links, file_links.index,
+                                      current_line, current_line_link)),
+      looking_up_buffer(false),
+      buffer_lookup_id(0) {}
+
+void FileLinkLookupController::findFileLinks(const QString& text) {
+  file_links = FileLinks();
+  looking_up_buffer = false;
+  buffer_lookup_id++;
+  pending_writes.clear();
+  FindFileLinks(text, file_links);
+}
+
+void FileLinkLookupController::findFileLinksInAppendedText(
+    const QString& text) {
+  FindFileLinksInAppendedText(text, file_links);
+}
+
+void FileLinkLookupController::findFileLinksInWrittenText(
+    int offset, const QString& text) {
+  if (looking_up_buffer) {
+    pending_writes.append(std::make_pair(offset, text));
+  } else {
+    FindFileLinksInWrittenText(offset, text, file_links);
+  }
+}
+
+void FileLinkLookupController::findFileLinksInBuffer(const QVariant& buffer) {
+  findFileLinks(QString());
+  // Links of a huge text are looked up on the global thread pool. Its copy
+  // gets detached, since the original keeps being appended to.
+  auto text = buffer.value<TextBuffer>().Detached();
+  if (text.IsEmpty()) {
+    return;
+  }
+  looking_up_buffer = true;
+  int id = buffer_lookup_id;
+  Promise<FileLinks> result = QtConcurrent::run([text] {
+    // Go through the text piece by piece instead of copying all of it at
+    // once: it can be memory-mapped from a huge file.
+    FileLinks links;
+    for (int i = 0; i < text.GetSize(); i += TextBuffer::kChunkSize) {
+      FindFileLinksInAppendedText(text.GetText(i, TextBuffer::kChunkSize),
+                                  links);
+    }
+    return links;
+  });
+  result.Then(this, [this, id](FileLinks result) {
+    if (id != buffer_lookup_id) {
+      return;
+    }
+    file_links = result;
+    looking_up_buffer = false;
+    for (const auto& [offset, text] : pending_writes) {
+      FindFileLinksInWrittenText(offset, text, file_links);
+    }
+    pending_writes.clear();
+    emit rehighlightAllLines();
+  });
 }
 
 void FileLinkLookupController::setCurrentLine(int line) {
@@ -559,17 +779,18 @@ void FileLinkLookupController::setCurrentLine(int line) {
 }
 
 void FileLinkLookupController::openCurrentFileLink() {
-  if (!index.contains(current_line)) {
+  if (!file_links.index.contains(current_line)) {
     return;
   }
-  int i = index[current_line][current_line_link];
-  const FileLink& link = links[i];
+  int i = file_links.index[current_line][current_line_link];
+  const FileLink& link = file_links.links[i];
   Application::Get().editor.OpenFile(link.file_path, link.line_num,
                                      link.col_num);
 }
 
 void FileLinkLookupController::goToLink(bool next) {
   int i;
+  const QList<FileLink>& links = file_links.links;
   for (i = 0; i < links.size() && links[i].line < current_line; i++) {
   }
   i += current_line_link;
@@ -579,30 +800,8 @@ void FileLinkLookupController::goToLink(bool next) {
   }
   int old = current_line;
   current_line = links[i].line;
-  current_line_link = index[current_line].indexOf(i);
+  current_line_link = file_links.index[current_line].indexOf(i);
   emit rehighlightLine(old);
   emit rehighlightLine(current_line);
   emit linkInLineSelected(current_line);
 }
-
-void FileLinkLookupController::FindFileLinks(const QRegularExpression& regex,
-                                             const QString& text) {
-  int line = 0;
-  int pos = 0;
-  for (auto it = regex.globalMatch(text); it.hasNext();) {
-    QRegularExpressionMatch m = it.next();
-    FileLink link;
-    link.file_path = m.captured(1);
-    link.offset = m.capturedStart();
-    link.length = m.capturedLength();
-    link.line_num = m.captured(2).toInt();
-    if (m.lastCapturedIndex() > 2) {
-      link.col_num = m.captured(3).toInt();
-    }
-    line += text.sliced(pos, link.offset - pos).count('\n');
-    link.line = line;
-    pos = link.offset;
-    index[line].append(links.size());
-    links.append(link);
-  }
-}
@@ -5,6 +5,9 @@
 #include <QSyntaxHighlighter>
 #include <QtQmlIntegration>
 
+#include "line_times.h"
+#include "text_buffer.h"
+
 struct TextSegment {
   int offset = 0;
   int length = 0;
@@ -125,8 +128,12 @@ class TextSearchController : public QObject {
   QString GetSearchResultsCount() const;
 
  public slots:
-  void search(const QString& term, const QString& text, bool select_result,
+  // Text is either a string or a TextBuffer.
+  void search(const QString& term, const QVariant& text, bool select_result,
               bool notify_results_changed);
+  // Only searches the text starting from the offset, which is the start of
+  // the line, that might have been changed since the last search.
+  void searchAppended(const QString& term, const QVariant& text, int offset);
   void replaceSearchResultWith(const QString& text, bool replace_all);
   void goToResultWithStartAt(int text_position);
   void goToSearchResult(bool next);
@@ -140,6 +147,7 @@ class TextSearchController : public QObject {
 
  private:
   void DisplaySelectedSearchResult();
+  void Search(const QString& term, const TextBuffer& text, int offset);
 
   int selected_result = 0;
   QList<TextSegment> results;
@@ -162,6 +170,14 @@ class FileLinkFormatter : public TextFormatter {
   QTextCharFormat format;
 };
 
+struct FileLinks {
+  QList<FileLink> links;
+  QHash<int, QList<int>> index;
+  int last_line = 0;
+  int last_line_offset = 0;
+  QString last_line_text;
+};
+
 class FileLinkLookupController : public QObject {
   Q_OBJECT
   QML_ELEMENT
@@ -171,28 +187,37 @@ class FileLinkLookupController : public QObject {
 
  public slots:
   void findFileLinks(const QString& text);
+  void findFileLinksInAppendedText(const QString& text);
+  void findFileLinksInWrittenText(int offset, const QString& text);
+  void findFileLinksInBuffer(const QVariant& buffer);
   void setCurrentLine(int line);
   void openCurrentFileLink();
   void goToLink(bool next);
 
  signals:
   void rehighlightLine(int line);
+  void rehighlightAllLines();
   void linkInLineSelected(int line);
 
  private:
-  void FindFileLinks(const QRegularExpression& regex, const QString& text);
-
   int current_line;
   int current_line_link;
+  FileLinks file_links;
   FileLinkFormatter* formatter;
-  QList<FileLink> links;
-  QHash<int, QList<int>> index;
+  // Text, that gets written while links of the whole buffer are being looked
+  // up, waits for the lookup to finish.
+  bool looking_up_buffer;
+  int buffer_lookup_id;
+  QList<std::pair<int, QString>> pending_writes;
 };
 
 class BigTextAreaModel : public QAbstractListModel {
   Q_OBJECT
   QML_ELEMENT
   Q_PROPERTY(QString text WRITE SetText READ GetText NOTIFY textChanged)
+  Q_PROPERTY(QVariant buffer WRITE SetBuffer READ GetBuffer NOTIFY textChanged)
+  Q_PROPERTY(QVariant lineTimes WRITE SetLineTimes READ GetLineTimes NOTIFY
+                 lineTimesChanged)
   Q_PROPERTY(bool cursorFollowEnd MEMBER cursor_follow_end NOTIFY
                  cursorFollowEndChanged)
   Q_PROPERTY(
@@ -209,9 +234,15 @@ class BigTextAreaModel : public QAbstractListModel {
   QVariant data(const QModelIndex& index, int role) const;
   void SetText(const QString& text);
   QString GetText() const;
+  void SetBuffer(const QVariant& buffer);
+  QVariant GetBuffer() const;
+  void SetLineTimes(const QVariant& line_times);
+  QVariant GetLineTimes() const;
   int GetLineNumberMaxWidth() const;
 
  public slots:
+  void appendText(const QString& text);
+  void appendLineTimes(int first_line, const QVariant& line_times);
   void selectInline(int line, int start, int end);
   void selectLine(int line);
   void selectAll();
@@ -221,24 +252,30 @@ class BigTextAreaModel : public QAbstractListModel {
   int getSelectionOffset();
   QString getSelectedText();
   void rehighlight();
+  void goToLargestTimeGap();
 
  signals:
   void textChanged();
+  void lineTimesChanged();
   void cursorFollowEndChanged();
   void goToLine(int line);
   void rehighlightLines(int first, int last);
+  // Text starting from the offset has changed.
+  void textExtended(int offset);
   void cursorPositionChanged();
   void fontChanged();
 
  private:
-  int GetLineLength(int line) const;
-  int GetLineWithOffset(int offset) const;
+  void ResetText();
+  void ExtendText(const TextBuffer& extended);
   std::pair<int, int> GetSelectionRange(const TextSelection& s) const;
 
   bool cursor_follow_end;
   int cursor_position;
-  QString text;
-  QList<int> line_start_offsets;
+  TextBuffer text;
+  // Text, that is displayed from a buffer, shares its storage with it.
+  bool text_is_shared;
+  LineTimes line_times;
   TextSelection selection;
   SelectionFormatter* selection_formatter;
   QFont font;
@@ -0,0 +1,556 @@
+#include "text_buffer.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QMutexLocker>
+#include <QUuid>
+#include <algorithm>
+
+#define LOG() qDebug() << "[TextBuffer]"
+
+TextBuffer::TextBuffer()
+    : data(QSharedPointer<Data>::create()),
+      size(0),
+      line_count(1),
+      tail_cursor(0) {}
+
+TextBuffer TextBuffer::ReadSpillFile(const QString& path,
+                                     const QByteArray& line_index) {
+  TextBuffer buffer;
+  auto spill_file = QSharedPointer<SpillFile>::create();
+  spill_file->file.setFileName(path);
+  spill_file->persistent = true;
+  if (!spill_file->file.open(QFile::ReadOnly)) {
+    LOG() << "Failed to open spill file" << path;
+    return buffer;
+  }
+  Data& data = *buffer.data;
+  data.spill_file = spill_file;
+  qint64 length = spill_file->file.size() / sizeof(QChar);
+  if (length > kMaxSize) {
+    LOG() << "Spill file" << path << "is too large - reading only its first"
+          << kMaxSize << "characters";
+    length = kMaxSize;
+  }
+  int mapped_size = 0;
+  for (qint64 offset = 0; offset < length; offset += kChunkSize) {
+    int count = std::min(static_cast<qint64>(kChunkSize), length - offset);
+    uchar* mem =
+        spill_file->file.map(offset * sizeof(QChar), count * sizeof(QChar));
+    if (!mem) {
+      LOG() << "Failed to map spill file" << path << "at offset" << offset;
+      break;
+    }
+    data.chunks.append(
+        QString::fromRawData(reinterpret_cast<const QChar*>(mem), count));
+    data.spilled_chunk_count++;
+    mapped_size += count;
+  }
+  if (line_index.isEmpty() || !ReadLineIndex(line_index, data) ||
+      data.size != mapped_size) {
+    data.line_start_offsets = {0};
+    data.line_count = 1;
+    data.size = 0;
+    for (const QString& chunk : data.chunks) {
+      buffer.IndexLines(chunk);
+      data.size += chunk.size();
+    }
+  }
+  buffer.size = data.size;
+  buffer.line_count = data.line_count;
+  return buffer;
+}
+
+TextBuffer TextBuffer::Decompress(
+    const QByteArray& line_index,
+    const QList<std::pair<QByteArray, int>>& pieces) {
+  TextBuffer buffer;
+  Data& data = *buffer.data;
+  if (!ReadLineIndex(line_index, data)) {
+    LOG() << "Failed to decompress text: data is corrupted";
+    return TextBuffer();
+  }
+  QList<QByteArray> compressed_chunks;
+  QList<int> chunk_offsets;
+  int offset = 0;
+  for (const auto& [compressed, length] : pieces) {
+    compressed_chunks.append(compressed);
+    chunk_offsets.append(offset);
+    offset += length;
+  }
+  if (offset != data.size) {
+    LOG() << "Failed to decompress text: data is corrupted";
+    return TextBuffer();
+  }
+  data.chunks.resize(compressed_chunks.size());
+  data.compressed_chunks = compressed_chunks;
+  data.compressed_chunk_offsets = chunk_offsets;
+  buffer.size = data.size;
+  buffer.line_count = data.line_count;
+  return buffer;
+}
+
+QByteArray TextBuffer::CompressPiece(QStringView text) {
+  return qCompress(reinterpret_cast<const uchar*>(text.data()),
+                   text.size() * sizeof(QChar));
+}
+
+QByteArray TextBuffer::CompressLineIndex() const {
+  // Lines mostly have similar lengths so distances between their starts
+  // compress better than the offsets themselves.
+  QByteArray line_bytes;
+  QDataStream lines(&line_bytes, QIODevice::WriteOnly);
+  int previous = 0;
+  for (int i = 0; i < GetIndexedLineCount(); i++) {
+    int offset = data->line_start_offsets[i];
+    lines << offset - previous;
+    previous = offset;
+  }
+  QByteArray bytes;
+  QDataStream out(&bytes, QIODevice::WriteOnly);
+  out << size << line_count << qCompress(line_bytes) << kLineIndexStep;
+  return bytes;
+}
+
+bool TextBuffer::ReadLineIndex(const QByteArray& bytes, Data& data) {
+  int size = 0;
+  int line_count = 0;
+  QByteArray line_bytes;
+  int step = 0;
+  QDataStream in(bytes);
+  in >> size >> line_count >> line_bytes >> step;
+  if (in.status() != QDataStream::Ok || size < 0 || line_count < 1 ||
+      step != kLineIndexStep) {
+    return false;
+  }
+  QDataStream lines(qUncompress(line_bytes));
+  data.line_start_offsets.clear();
+  int offset = 0;
+  for (int i = 0; i < (line_count - 1) / kLineIndexStep + 1; i++) {
+    int delta = 0;
+    lines >> delta;
+    offset += delta;
+    data.line_start_offsets.append(offset);
+  }
+  if (lines.status() != QDataStream::Ok) {
+    return false;
+  }
+  data.size = size;
+  data.line_count = line_count;
+  return true;
+}
+
+static QList<quint64> MakeGearTable() {
+  // splitmix64 with a fixed seed: pieces of the same text must always have
+  // the same boundaries.
+  QList<quint64> table;
+  quint64 x = 0;
+  for (int i = 0; i < 256; i++) {
+    x += 0x9e3779b97f4a7c15ULL;
+    quint64 z = x;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    table.append(z ^ (z >> 31));
+  }
+  return table;
+}
+
+QList<TextBuffer::Piece> TextBuffer::SplitIntoPieces() const {
+  // Boundaries are placed where a rolling "gear" hash of the last 64
+  // characters matches a pattern, so a change in the text only affects
+  // pieces around it. Top 13 bits of the hash being zero gives pieces of
+  // ~8K characters on average.
+  static const QList<quint64> kGear = MakeGearTable();
+  static const quint64 kBoundaryMask = 0x1fffULL << 51;
+  static const int kMinPieceSize = 2 * 1024;
+  QList<Piece> pieces;
+  QCryptographicHash hash(QCryptographicHash::Sha256);
+  Piece piece;
+  quint64 fingerprint = 0;
+  for (int offset = 0; offset < size; offset += kChunkSize) {
+    QString chunk = GetText(offset, kChunkSize);
+    int start = 0;
+    for (int i = 0; i < chunk.size(); i++) {
+      char16_t c = chunk[i].unicode();
+      fingerprint = (fingerprint << 1) + kGear[(c ^ (c >> 8)) & 0xff];
+      piece.length++;
+      if (piece.length < kChunkSize &&
+          (piece.length < kMinPieceSize || (fingerprint & kBoundaryMask))) {
+        continue;
+      }
+      hash.addData(QByteArrayView(
+          reinterpret_cast<const char*>(chunk.constData() + start),
+          (i + 1 - start) * sizeof(QChar)));
+      piece.hash = hash.result();
+      pieces.append(piece);
+      hash.reset();
+      piece.offset += piece.length;
+      piece.length = 0;
+      start = i + 1;
+    }
+    hash.addData(
+        QByteArrayView(reinterpret_cast<const char*>(chunk.constData() + start),
+                       (chunk.size() - start) * sizeof(QChar)));
+  }
+  if (piece.length > 0) {
+    piece.hash = hash.result();
+    pieces.append(piece);
+  }
+  return pieces;
+}
+
+void TextBuffer::SetSpillFolder(const QString& folder, int threshold) {
+  data->spill_folder = folder;
+  data->spill_threshold = threshold;
+}
+
+QString TextBuffer::PersistSpillFile() {
+  if (!data->spill_file) {
+    return QString();
+  }
+  AppendToStorage(TakeTail());
+  SpillChunks(data->chunks.size());
+  if (data->spilled_chunk_count < data->chunks.size()) {
+    return QString();
+  }
+  data->spill_folder.clear();
+  data->spill_file->persistent = true;
+  return data->spill_file->file.fileName();
+}
+
+void TextBuffer::Append(QStringView text) {
+  AppendToStorage(TakeTail());
+  AppendToStorage(text);
+}
+
+int TextBuffer::Write(QStringView text) {
+  text = text.first(
+      std::min(text.size(), static_cast<qsizetype>(kMaxSize - size)));
+  int changed_offset = size;
+  int cursor = tail_cursor;
+  QString line = TakeTail();
+  qsizetype pos = 0;
+  while (pos < text.size()) {
+    qsizetype end = pos;
+    while (end < text.size() && text[end] != '\r' && text[end] != '\n') {
+      end++;
+    }
+    if (end > pos) {
+      changed_offset = std::min(changed_offset, size + cursor);
+      qsizetype count = end - pos;
+      line.replace(cursor, std::min(count, line.size() - cursor),
+                   text.sliced(pos, count).toString());
+      cursor += count;
+    }
+    if (end == text.size()) {
+      break;
+    }
+    if (text[end] == '\n') {
+      line.append('\n');
+      AppendToStorage(line);
+      line.clear();
+    }
+    cursor = 0;
+    pos = end + 1;
+  }
+  // A line, that never ends, should not grow in memory forever, so once it
+  // gets big enough it is stored as is and can no longer be overwritten.
+  if (line.size() >= kChunkSize && cursor == line.size()) {
+    AppendToStorage(line);
+    line.clear();
+    cursor = 0;
+  }
+  tail = line;
+  tail_cursor = cursor;
+  size += tail.size();
+  return changed_offset;
+}
+
+void TextBuffer::Clear() {
+  auto empty = QSharedPointer<Data>::create();
+  empty->spill_folder = data->spill_folder;
+  empty->spill_threshold = data->spill_threshold;
+  data = empty;
+  size = 0;
+  line_count = 1;
+  tail.clear();
+  tail_cursor = 0;
+}
+
+TextBuffer TextBuffer::Detached() const {
+  TextBuffer copy = *this;
+  // Compressed storage never changes.
+  if (data->compressed_chunks.isEmpty()) {
+    copy.TakeTail();
+    copy.Detach();
+    copy.tail = tail;
+    copy.tail_cursor = tail_cursor;
+    copy.size += tail.size();
+  }
+  return copy;
+}
+
+bool TextBuffer::IsEmpty() const { return size == 0; }
+
+bool TextBuffer::IsContinuedBy(const TextBuffer& another) const {
+  return data == another.data &&
+         size - tail.size() <= another.size - another.tail.size();
+}
+
+int TextBuffer::GetSize() const { return size; }
+
+int TextBuffer::GetLineCount() const { return size == 0 ? 0 : line_count; }
+
+int TextBuffer::GetLineOffset(int line) const {
+  if (line < 0 || line >= GetLineCount()) {
+    return 0;
+  }
+  int offset = data->line_start_offsets[line / kLineIndexStep];
+  for (int i = 0; i < line % kLineIndexStep; i++) {
+    offset = FindLineEnd(offset) + 1;
+  }
+  return offset;
+}
+
+int TextBuffer::GetLineLength(int line) const {
+  if (line < 0 || line >= GetLineCount()) {
+    return 0;
+  }
+  int start = GetLineOffset(line);
+  return FindLineEnd(start) - start;
+}
+
+int TextBuffer::GetLineWithOffset(int offset) const {
+  auto begin = data->line_start_offsets.cbegin();
+  auto it = std::upper_bound(begin, begin + GetIndexedLineCount(), offset);
+  int i = std::max(static_cast<int>(it - begin) - 1, 0);
+  int line = i * kLineIndexStep;
+  int line_offset = data->line_start_offsets[i];
+  while (line < line_count - 1) {
+    int end = FindLineEnd(line_offset);
+    if (end >= offset) {
+      break;
+    }
+    line_offset = end + 1;
+    line++;
+  }
+  return line;
+}
+
+QString TextBuffer::GetLine(int line) const {
+  return GetText(GetLineOffset(line), GetLineLength(line));
+}
+
+QString TextBuffer::GetText(int offset, int length) const {
+  offset = std::clamp(offset, 0, size);
+  length = std::clamp(length, 0, size - offset);
+  QString result;
+  result.reserve(length);
+  int stored_size = size - tail.size();
+  while (length > 0 && offset < stored_size) {
+    int i = GetChunkIndex(offset);
+    QString chunk = GetChunk(i);
+    int chunk_offset = offset - GetChunkOffset(i);
+    int count = std::min(static_cast<int>(chunk.size()) - chunk_offset, length);
+    result.append(QStringView(chunk).sliced(chunk_offset, count));
+    offset += count;
+    length -= count;
+  }
+  if (length > 0) {
+    result.append(QStringView(tail).sliced(offset - stored_size, length));
+  }
+  return result;
+}
+
+QString TextBuffer::GetText() const { return GetText(0, size); }
+
+int TextBuffer::GetIndexedLineCount() const {
+  return (line_count - 1) / kLineIndexStep + 1;
+}
+
+int TextBuffer::FindLineEnd(int offset) const {
+  // The tail never contains line breaks.
+  int stored_size = size - tail.size();
+  while (offset < stored_size) {
+    int i = GetChunkIndex(offset);
+    QString chunk = GetChunk(i);
+    int chunk_offset = GetChunkOffset(i);
+    int end = std::min(static_cast<int>(chunk.size()),
+                       stored_size - chunk_offset);
+    qsizetype pos =
+        QStringView(chunk).first(end).indexOf('\n', offset - chunk_offset);
+    if (pos >= 0) {
+      return chunk_offset + pos;
+    }
+    offset = chunk_offset + end;
+  }
+  return size;
+}
+
+int TextBuffer::GetChunkIndex(int offset) const {
+  const QList<int>& offsets = data->compressed_chunk_offsets;
+  if (offsets.isEmpty()) {
+    return offset / kChunkSize;
+  }
+  auto it = std::upper_bound(offsets.cbegin(), offsets.cend(), offset);
+  return std::max(static_cast<int>(it - offsets.cbegin()) - 1, 0);
+}
+
+int TextBuffer::GetChunkOffset(int i) const {
+  const QList<int>& offsets = data->compressed_chunk_offsets;
+  return offsets.isEmpty() ? i * kChunkSize : offsets[i];
+}
+
+QString TextBuffer::GetChunk(int i) const {
+  if (data->compressed_chunks.isEmpty()) {
+    return data->chunks.at(i);
+  }
+  // Copies of a decompressed buffer share the cache of decompressed chunks,
+  // which gets updated while they are being read.
+  QMutexLocker lock(&data->decompressed_chunks_mutex);
+  QString& chunk = data->chunks[i];
+  if (!chunk.isNull()) {
+    return chunk;
+  }
+  if (data->decompressed_chunks.size() >= kMaxDecompressedChunks) {
+    data->chunks[data->decompressed_chunks.takeFirst()] = QString();
+  }
+  QByteArray bytes = qUncompress(data->compressed_chunks[i]);
+  chunk = QString(reinterpret_cast<const QChar*>(bytes.constData()),
+                  bytes.size() / sizeof(QChar));
+  data->decompressed_chunks.append(i);
+  return chunk;
+}
+
+void TextBuffer::Detach() {
+  if (!data->compressed_chunks.isEmpty()) {
+    // Compressed pieces don't have to be of the same size as regular chunks.
+    TextBuffer copy;
+    for (int offset = 0; offset < size; offset += kChunkSize) {
+      copy.Append(GetText(offset, kChunkSize));
+    }
+    data = copy.data;
+    return;
+  }
+  auto copy = QSharedPointer<Data>::create();
+  int chunk_count = (size + kChunkSize - 1) / kChunkSize;
+  copy->chunks = data->chunks.mid(0, chunk_count);
+  if (size % kChunkSize != 0) {
+    copy->chunks.last().truncate(size % kChunkSize);
+  }
+  copy->line_start_offsets =
+      data->line_start_offsets.mid(0, GetIndexedLineCount());
+  copy->line_count = line_count;
+  copy->size = size;
+  // Spilled chunks of the copy still point to the memory-mapped file, but
+  // only the original buffer writes to it.
+  copy->spill_file = data->spill_file;
+  data = copy;
+}
+
+void TextBuffer::AppendToStorage(QStringView text) {
+  int capacity = kMaxSize - size;
+  if (text.size() > capacity) {
+    if (capacity > 0) {
+      LOG() << "Text has reached its maximum size - dropping the rest of it";
+    }
+    text = text.first(capacity);
+  }
+  if (text.isEmpty()) {
+    return;
+  }
+  if (data->size != size || !data->compressed_chunks.isEmpty()) {
+    Detach();
+  }
+  IndexLines(text);
+  qsizetype pos = 0;
+  while (pos < text.size()) {
+    if (data->chunks.isEmpty() ||
+        data->chunks.constLast().size() == kChunkSize) {
+      data->chunks.append(QString());
+    }
+    QString& chunk = data->chunks.last();
+    qsizetype count = std::min(kChunkSize - chunk.size(), text.size() - pos);
+    chunk.append(text.sliced(pos, count));
+    pos += count;
+  }
+  data->size += text.size();
+  size = data->size;
+  line_count = data->line_count;
+  if (!data->spill_folder.isEmpty() && size > data->spill_threshold) {
+    SpillChunks(size / kChunkSize);
+  }
+}
+
+QString TextBuffer::TakeTail() {
+  QString result = tail;
+  size -= tail.size();
+  tail.clear();
+  tail_cursor = 0;
+  return result;
+}
+
+void TextBuffer::IndexLines(QStringView text) {
+  qsizetype pos = 0;
+  while (true) {
+    qsizetype i = text.indexOf('\n', pos);
+    if (i < 0) {
+      break;
+    }
+    if (data->line_count % kLineIndexStep == 0) {
+      data->line_start_offsets.append(data->size + i + 1);
+    }
+    data->line_count++;
+    pos = i + 1;
+  }
+}
+
+void TextBuffer::SpillChunks(int count) {
+  if (data->spilled_chunk_count >= count) {
+    return;
+  }
+  if (!data->spill_file) {
+    auto spill_file = QSharedPointer<SpillFile>::create();
+    QDir().mkpath(data->spill_folder);
+    spill_file->file.setFileName(
+        data->spill_folder + '/' +
+        QUuid::createUuid().toString(QUuid::WithoutBraces));
+    if (!spill_file->file.open(QFile::ReadWrite | QFile::Truncate)) {
+      LOG() << "Failed to create spill file" << spill_file->file.fileName()
+            << "- keeping text in memory";
+      data->spill_folder.clear();
+      return;
+    }
+    LOG() << "Spilling text to" << spill_file->file.fileName();
+    data->spill_file = spill_file;
+  }
+  QFile& file = data->spill_file->file;
+  for (int i = data->spilled_chunk_count; i < count; i++) {
+    QString& chunk = data->chunks[i];
+    qint64 offset = static_cast<qint64>(i) * kChunkSize * sizeof(QChar);
+    qint64 length = chunk.size() * sizeof(QChar);
+    auto bytes = reinterpret_cast<const char*>(chunk.constData());
+    uchar* mem = nullptr;
+    if (file.seek(offset) && file.write(bytes, length) == length &&
+        file.flush()) {
+      mem = file.map(offset, length);
+    }
+    if (!mem) {
+      LOG() << "Failed to spill text to" << file.fileName() << ":"
+            << file.errorString() << "- keeping text in memory";
+      data->spill_folder.clear();
+      return;
+    }
+    chunk = QString::fromRawData(reinterpret_cast<const QChar*>(mem),
+                                 chunk.size());
+    data->spilled_chunk_count = i + 1;
+  }
+}
+
+TextBuffer::SpillFile::~SpillFile() {
+  if (!persistent) {
+    file.remove();
+  }
+}
@@ -0,0 +1,139 @@
+#ifndef TEXTBUFFER_H
+#define TEXTBUFFER_H
+
+#include <QFile>
+#include <QList>
+#include <QMetaType>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringView>
+
+/**
+ * Append-only text, stored in fixed-size chunks, that keeps track of the
+ * offsets at which each of its lines start. Appending a piece of text costs
+ * proportionally to the size of that piece, no matter how much text has
+ * already been appended.
+ *
+ * Text can also be written to a buffer the way a terminal would display it,
+ * where "\r" moves back to the start of the current line and whatever gets
+ * written next overwrites it. Such a line is kept aside until it ends, so a
+ * progress bar, that is redrawn thousands of times, ends up as a single line.
+ *
+ * Copies of a buffer share the underlying storage and only remember how much
+ * of it they can see, which makes them cheap snapshots. Appending to a
+ * snapshot that has fallen behind the storage it shares detaches it. Since
+ * storage is shared without locking, snapshots should only be read on the
+ * thread that appends to the original buffer or after the appends stop.
+ *
+ * A buffer can be told to spill to disk: once it grows past the threshold, its
+ * full chunks get written to a file and are read back via memory mapping, so
+ * the amount of memory it occupies stays bounded. Only the start of every
+ * kLineIndexStep-th line is indexed: lines in between are found by scanning
+ * the text after the nearest indexed one, which keeps the index small.
+ *
+ * A buffer can't hold more than kMaxSize characters (2 GB of UTF-16), so
+ * that its offsets fit into int: text beyond that is dropped. Owners of
+ * buffers, that can receive unlimited amounts of text, should elide it
+ * before it gets there.
+ *
+ * A buffer can also be split into pieces, whose boundaries depend on the
+ * content of the text, so that identical parts of different texts end up in
+ * identical pieces and can be stored once. A buffer restored from its
+ * compressed pieces only decompresses them when they are read and keeps just a
+ * few of them decompressed at a time. Such a buffer never changes, so unlike
+ * other buffers it and its copies can be read from any thread: the chunks,
+ * that are currently decompressed, are guarded by a mutex.
+ */
+class TextBuffer {
+ public:
+  struct Piece {
+    QByteArray hash;
+    int offset = 0;
+    int length = 0;
+  };
+
+  TextBuffer();
+  // Line index, that has been saved along with the file, saves scanning all
+  // of its text.
+  static TextBuffer ReadSpillFile(const QString& path,
+                                  const QByteArray& line_index = {});
+  static TextBuffer Decompress(
+      const QByteArray& line_index,
+      const QList<std::pair<QByteArray, int>>& pieces = {});
+  static QByteArray CompressPiece(QStringView text);
+  QByteArray CompressLineIndex() const;
+  QList<Piece> SplitIntoPieces() const;
+  void SetSpillFolder(const QString& folder, int threshold);
+  QString PersistSpillFile();
+  void Append(QStringView text);
+  // Returns the offset starting from which the text has changed.
+  int Write(QStringView text);
+  void Clear();
+  // Copy, that does not share storage, that keeps changing, with this buffer,
+  // so it can be appended to independently and read on another thread.
+  TextBuffer Detached() const;
+  bool IsEmpty() const;
+  // Another buffer has all the lines of this one, except for the last one,
+  // which might have been overwritten since.
+  bool IsContinuedBy(const TextBuffer& another) const;
+  int GetSize() const;
+  int GetLineCount() const;
+  int GetLineOffset(int line) const;
+  int GetLineLength(int line) const;
+  int GetLineWithOffset(int offset) const;
+  QString GetLine(int line) const;
+  QString GetText(int offset, int length) const;
+  QString GetText() const;
+
+  inline static const int kChunkSize = 64 * 1024;
+  inline static const int kMaxDecompressedChunks = 16;
+  inline static const int kLineIndexStep = 32;
+  inline static const int kMaxSize = 1 << 30;
+
+ private:
+  struct SpillFile {
+    ~SpillFile();
+
+    QFile file;
+    bool persistent = false;
+  };
+
+  struct Data {
+    QList<QString> chunks;
+    // Offsets of starts of every kLineIndexStep-th line.
+    QList<int> line_start_offsets = {0};
+    int line_count = 1;
+    int size = 0;
+    QString spill_folder;
+    int spill_threshold = 0;
+    int spilled_chunk_count = 0;
+    QSharedPointer<SpillFile> spill_file;
+    QList<QByteArray> compressed_chunks;
+    QList<int> compressed_chunk_offsets;
+    QList<int> decompressed_chunks;
+    QMutex decompressed_chunks_mutex;
+  };
+
+  static bool ReadLineIndex(const QByteArray& bytes, Data& data);
+  int GetIndexedLineCount() const;
+  int FindLineEnd(int offset) const;
+  int GetChunkIndex(int offset) const;
+  int GetChunkOffset(int i) const;
+  QString GetChunk(int i) const;
+  void Detach();
+  void AppendToStorage(QStringView text);
+  QString TakeTail();
+  void IndexLines(QStringView text);
+  void SpillChunks(int count);
+
+  QSharedPointer<Data> data;
+  int size;
+  int line_count;
+  QString tail;
+  int tail_cursor;
+};
+
+Q_DECLARE_METATYPE(TextBuffer)
+
+#endif  // TEXTBUFFER_H
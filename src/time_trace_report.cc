@@ -0,0 +1,204 @@
+#include "time_trace_report.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtConcurrent>
+#include <algorithm>
+
+#include "threads.h"
+
+#define LOG() qDebug() << "[TimeTraceReport]"
+
+QString TimeTraceEntry::GetCategoryName(Category category) {
+  switch (category) {
+    case kFrontend:
+      return "Parsing";
+    case kBackend:
+      return "Code Generation";
+    case kHeader:
+      return "Header";
+    case kTemplate:
+      return "Template Instantiation";
+    case kFunction:
+      return "Function Code Generation";
+    default:
+      return "";
+  }
+}
+
+// Build tools other than Ninja don't log the files, that they have built, so
+// the whole build folder gets searched for traces, that have an object file
+// next to them.
+static QStringList FindTracesInFolderSync(const QString& build_folder,
+                                          const QDateTime& since) {
+  QStringList traces;
+  QDirIterator it(build_folder, {"*.json"}, QDir::Files,
+                  QDirIterator::Subdirectories);
+  while (it.hasNext()) {
+    it.next();
+    QFileInfo info = it.fileInfo();
+    if (info.lastModified() < since) {
+      continue;
+    }
+    QString base = info.absolutePath() + '/' + info.completeBaseName();
+    if (QFile::exists(base + ".o") || QFile::exists(base + ".obj")) {
+      traces.append(info.absoluteFilePath());
+    }
+  }
+  return traces;
+}
+
+QStringList TimeTraceReport::FindTracesSync(const QString& build_folder,
+                                            const QList<NinjaLogEntry>& steps,
+                                            const QDateTime& since) {
+  if (!QFile::exists(NinjaLog::GetPath(build_folder))) {
+    return FindTracesInFolderSync(build_folder, since);
+  }
+  QStringList traces;
+  for (const NinjaLogEntry& step : steps) {
+    if (!step.output.endsWith(".o") && !step.output.endsWith(".obj")) {
+      continue;
+    }
+    // clang replaces extension of the object file with ".json".
+    QString path = step.output.left(step.output.lastIndexOf('.')) + ".json";
+    if (!QDir::isAbsolutePath(path)) {
+      path = QDir(build_folder).filePath(path);
+    }
+    // Traces, that are older than the build, are left from the times, when
+    // the project was configured with -ftime-trace.
+    QFileInfo info(path);
+    if (info.exists() && info.lastModified() >= since) {
+      traces.append(path);
+    }
+  }
+  return traces;
+}
+
+typedef QList<QHash<QString, TimeTraceEntry>> TimeTraceTotals;
+
+static void AddToTotals(TimeTraceTotals& totals,
+                        TimeTraceEntry::Category category, const QString& name,
+                        qint64 duration, int count) {
+  TimeTraceEntry& entry = totals[category][name];
+  entry.category = category;
+  entry.name = name;
+  entry.duration += duration;
+  entry.count += count;
+}
+
+static void ParseTrace(const QString& build_folder, const QString& path,
+                       TimeTraceTotals& totals) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return;
+  }
+  QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+  // Translation units are named after their object files.
+  QString unit = QDir(build_folder).relativeFilePath(path);
+  unit.chop(5);
+  for (const QJsonValue& value : doc["traceEvents"].toArray()) {
+    QJsonObject event = value.toObject();
+    if (event["ph"].toString() != "X") {
+      continue;
+    }
+    QString name = event["name"].toString();
+    qint64 duration = event["dur"].toInteger();
+    QString detail = event["args"].toObject()["detail"].toString();
+    if (name == "Total Frontend") {
+      AddToTotals(totals, TimeTraceEntry::kFrontend, unit, duration, 1);
+    } else if (name == "Total Backend") {
+      AddToTotals(totals, TimeTraceEntry::kBackend, unit, duration, 1);
+    } else if (name == "Source") {
+      AddToTotals(totals, TimeTraceEntry::kHeader, detail, duration, 1);
+    } else if (name == "InstantiateClass" || name == "InstantiateFunction") {
+      AddToTotals(totals, TimeTraceEntry::kTemplate, detail, duration, 1);
+    } else if (name == "CodeGen Function" || name == "OptFunction") {
+      AddToTotals(totals, TimeTraceEntry::kFunction, detail, duration, 1);
+    }
+  }
+}
+
+TimeTraceReport TimeTraceReport::CreateSync(const QString& build_folder,
+                                            const QStringList& traces,
+                                            int limit) {
+  LOG() << "Aggregating" << traces.size() << "traces of build in"
+        << build_folder;
+  QList<std::pair<int, int>> ranges =
+      Threads::SplitArrayAmongThreads(traces.size());
+  QList<TimeTraceTotals> totals_per_range(ranges.size());
+  for (TimeTraceTotals& totals : totals_per_range) {
+    totals.resize(TimeTraceEntry::kCategoryCount);
+  }
+  QList<int> range_indices;
+  for (int i = 0; i < ranges.size(); i++) {
+    range_indices.append(i);
+  }
+  QtConcurrent::blockingMap(range_indices, [&](int i) {
+    for (int j = ranges[i].first; j < ranges[i].second; j++) {
+      ParseTrace(build_folder, traces[j], totals_per_range[i]);
+    }
+  });
+  TimeTraceTotals totals(TimeTraceEntry::kCategoryCount);
+  for (const TimeTraceTotals& range_totals : totals_per_range) {
+    for (const QHash<QString, TimeTraceEntry>& category : range_totals) {
+      for (const TimeTraceEntry& entry : category) {
+        AddToTotals(totals, entry.category, entry.name, entry.duration,
+                    entry.count);
+      }
+    }
+  }
+  TimeTraceReport report;
+  report.trace_count = traces.size();
+  for (const QHash<QString, TimeTraceEntry>& category : totals) {
+    QList<TimeTraceEntry> entries = category.values();
+    std::sort(entries.begin(), entries.end(),
+              [](const TimeTraceEntry& a, const TimeTraceEntry& b) {
+                return a.duration > b.duration;
+              });
+    report.entries.append(
+        entries.mid(0, std::min(limit, static_cast<int>(entries.size()))));
+  }
+  return report;
+}
+
+TimeTraceReport TimeTraceReport::Deserialize(const QByteArray& bytes) {
+  TimeTraceReport report;
+  QJsonObject o = QJsonDocument::fromJson(bytes).object();
+  report.trace_count = o["trace_count"].toInt();
+  for (const QJsonValue& value : o["entries"].toArray()) {
+    QJsonObject e = value.toObject();
+    TimeTraceEntry entry;
+    entry.category = static_cast<TimeTraceEntry::Category>(
+        std::clamp(e["category"].toInt(), 0,
+                   static_cast<int>(TimeTraceEntry::kCategoryCount) - 1));
+    entry.name = e["name"].toString();
+    entry.duration = e["duration"].toInteger();
+    entry.count = e["count"].toInt();
+    report.entries.append(entry);
+  }
+  return report;
+}
+
+QByteArray TimeTraceReport::Serialize() const {
+  QJsonArray entries_array;
+  for (const TimeTraceEntry& entry : entries) {
+    QJsonObject e;
+    e["category"] = entry.category;
+    e["name"] = entry.name;
+    e["duration"] = entry.duration;
+    e["count"] = entry.count;
+    entries_array.append(e);
+  }
+  QJsonObject o;
+  o["trace_count"] = trace_count;
+  o["entries"] = entries_array;
+  return QJsonDocument(o).toJson(QJsonDocument::Compact);
+}
+
+bool TimeTraceReport::IsNull() const { return trace_count == 0; }
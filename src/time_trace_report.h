@@ -0,0 +1,56 @@
+#ifndef TIMETRACEREPORT_H
+#define TIMETRACEREPORT_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QList>
+#include <QString>
+
+#include "ninja_log.h"
+
+struct TimeTraceEntry {
+  enum Category {
+    kFrontend,
+    kBackend,
+    kHeader,
+    kTemplate,
+    kFunction,
+    kCategoryCount,
+  };
+
+  static QString GetCategoryName(Category category);
+
+  Category category = kFrontend;
+  QString name;
+  // Microseconds, summed over all the occurrences.
+  qint64 duration = 0;
+  int count = 0;
+};
+
+/**
+ * What a build has spent its time on, aggregated the way ClangBuildAnalyzer
+ * does it from -ftime-trace traces, that clang writes next to object files:
+ * translation units, that took longest to parse and to generate code for, as
+ * well as the most expensive headers, template instantiations and functions.
+ */
+struct TimeTraceReport {
+  // Traces of the object files, that have been compiled by a build since the
+  // specified time. Builds with Ninja only look at the objects, that its log
+  // lists as rebuilt, while builds with other tools scan the build folder.
+  static QStringList FindTracesSync(const QString& build_folder,
+                                    const QList<NinjaLogEntry>& steps,
+                                    const QDateTime& since);
+  // Traces get parsed in parallel. Only the most expensive entries of each
+  // category are kept.
+  static TimeTraceReport CreateSync(const QString& build_folder,
+                                    const QStringList& traces, int limit);
+  static TimeTraceReport Deserialize(const QByteArray& bytes);
+  QByteArray Serialize() const;
+  bool IsNull() const;
+
+  int trace_count = 0;
+  // Sorted by category and then by duration, from the most expensive one.
+  QList<TimeTraceEntry> entries;
+};
+
+#endif  // TIMETRACEREPORT_H
@@ -0,0 +1,44 @@
+#include "time_trace_report_model.h"
+
+#include "application.h"
+
+#define LOG() qDebug() << "[TimeTraceReportModel]"
+
+static QString FormatDuration(qint64 us) {
+  return QString::number(us / 1000000.0, 'f', 2) + 's';
+}
+
+TimeTraceReportModel::TimeTraceReportModel(QObject* parent)
+    : TextListModel(parent) {
+  SetRoleNames({{0, "title"}, {1, "subTitle"}, {2, "rightText"}});
+  searchable_roles = {0, 1};
+  SetEmptyListPlaceholder(
+      "Build has not produced any time traces. Configure it with "
+      "-ftime-trace to collect them.");
+  Application::Get().view.SetWindowTitle("Time Trace Report");
+  load();
+}
+
+void TimeTraceReportModel::load() {
+  Application& app = Application::Get();
+  QUuid id = app.task.GetSelectedExecutionId();
+  LOG() << "Loading time trace report of execution" << id;
+  SetPlaceholder("Loading time trace report...");
+  app.task.FetchTimeTraceReport(id).Then(
+      this, [this](const TimeTraceReport& result) {
+        report = result;
+        SetPlaceholder();
+        Load();
+      });
+}
+
+QVariantList TimeTraceReportModel::GetRow(int i) const {
+  const TimeTraceEntry& entry = report.entries[i];
+  QString details = TimeTraceEntry::GetCategoryName(entry.category);
+  if (entry.count > 1) {
+    details += " (" + QString::number(entry.count) + " times)";
+  }
+  return {entry.name, details, FormatDuration(entry.duration)};
+}
+
+int TimeTraceReportModel::GetRowCount() const { return report.entries.size(); }
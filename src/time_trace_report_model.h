@@ -0,0 +1,26 @@
+#ifndef TIMETRACEREPORTMODEL_H
+#define TIMETRACEREPORTMODEL_H
+
+#include <QObject>
+#include <QQmlEngine>
+
+#include "text_list_model.h"
+#include "time_trace_report.h"
+
+class TimeTraceReportModel : public TextListModel {
+  Q_OBJECT
+  QML_ELEMENT
+ public:
+  explicit TimeTraceReportModel(QObject* parent = nullptr);
+
+  TimeTraceReport report;
+
+ public slots:
+  void load();
+
+ protected:
+  QVariantList GetRow(int i) const;
+  int GetRowCount() const;
+};
+
+#endif  // TIMETRACEREPORTMODEL_H
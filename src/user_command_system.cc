@@ -148,6 +148,15 @@ void UserCommandSystem::Initialize() {
                 app.task.RunTaskOfExecution(app.task.GetLastExecution(), true,
                                             "GtestExecution.qml");
               });
+  RegisterCmd("Run", "Run Last Task On Changes", "Ctrl+Alt+R", cmds,
+              user_commands, default_user_cmd_index, [] {
+                Application& app = Application::Get();
+                app.task.RunTaskOfExecutionOnChanges(
+                    app.task.GetLastExecution(), "TaskExecution.qml");
+              });
+  RegisterCmd("Run", "Stop Running Task On Changes", "Ctrl+Alt+S", cmds,
+              user_commands, default_user_cmd_index,
+              [] { Application::Get().task.stopWatchingTask(); });
   RegisterCmd("Run", "Run CMake", "Ctrl+Shift+C", cmds, user_commands,
               default_user_cmd_index,
               [] { Application::Get().view.SetCurrentView("RunCmake.qml"); });
@@ -186,6 +195,16 @@ void UserCommandSystem::Initialize() {
   LOG() << "Committing global user command list";
   user_commands->Load();
   cmds.clear();
+  RegisterLocalCmd("TaskList", "Run With Profiling", "Alt+P", cmds,
+                   user_cmd_index);
+#if __linux__
+  RegisterLocalCmd("TaskList", "Run With Counters", "Alt+Shift+P", cmds,
+                   user_cmd_index);
+  RegisterLocalCmd("TaskList", "Run With Allocation Profiling", "Alt+A", cmds,
+                   user_cmd_index);
+#endif
+  RegisterLocalCmd("TaskList", "Run On Changes", "Alt+W", cmds,
+                   user_cmd_index);
   RegisterLocalCmd("TaskList", "Run as QtTest", "Alt+U", cmds, user_cmd_index);
   RegisterLocalCmd("TaskList", "Run as QtTest With Filter", "Ctrl+Alt+U", cmds,
                    user_cmd_index);
@@ -209,6 +228,14 @@ void UserCommandSystem::Initialize() {
                    user_cmd_index);
   RegisterLocalCmd("TaskExecutionList", "Open as Google Test", "Alt+G", cmds,
                    user_cmd_index);
+  RegisterLocalCmd("TaskExecutionList", "Open Time Trace Report", "Alt+T",
+                   cmds, user_cmd_index);
+  RegisterLocalCmd("TaskExecutionList", "Open CMake Profile", "Alt+P", cmds,
+                   user_cmd_index);
+  RegisterLocalCmd("TaskExecutionList", "Open Flame Graph", "Alt+F", cmds,
+                   user_cmd_index);
+  RegisterLocalCmd("TaskExecutionList", "Open Allocation Profile", "Alt+A",
+                   cmds, user_cmd_index);
   RegisterLocalCmd("TaskExecutionList", "Re-Run", "Alt+Shift+R", cmds,
                    user_cmd_index);
   RegisterLocalCmd("TaskExecutionList", "Re-Run as QtTest", "Alt+Shift+U", cmds,
@@ -265,6 +292,21 @@ void UserCommandSystem::Initialize() {
                    user_cmd_index);
   RegisterLocalCmd("TestExecution", "Re-Run Until Fails", "Ctrl+Alt+Shift+R",
                    cmds, user_cmd_index);
+  RegisterLocalCmd("TaskExecution", "Toggle Time Gaps", "Alt+T", cmds,
+                   user_cmd_index);
+  RegisterLocalCmd("TaskExecution", "Go To Largest Time Gap", "Ctrl+Alt+T",
+                   cmds, user_cmd_index);
+  RegisterLocalCmd("CmakeProfile", "Sort By Name", "Alt+N", cmds,
+                   user_cmd_index);
+  RegisterLocalCmd("CmakeProfile", "Sort By Time", "Alt+T", cmds,
+                   user_cmd_index);
+  RegisterLocalCmd("CmakeProfile", "Sort By Self Time", "Alt+S", cmds,
+                   user_cmd_index);
+  RegisterLocalCmd("CmakeProfile", "Sort By Calls", "Alt+C", cmds,
+                   user_cmd_index);
+  RegisterLocalCmd("FlameGraph", "Zoom Out", "Alt+Z", cmds, user_cmd_index);
+  RegisterLocalCmd("FlameGraph", "Reset Zoom", "Alt+Shift+Z", cmds,
+                   user_cmd_index);
   RegisterLocalCmd("FileLinkLookup", "Open File In Editor", "Ctrl+O", cmds,
                    user_cmd_index);
   RegisterLocalCmd("FileLinkLookup", "Previous File Link", "Ctrl+Alt+Up", cmds,
@@ -0,0 +1,21 @@
+#include "varint.h"
+
+void VarInt::Write(QByteArray& bytes, quint32 value) {
+  while (value >= 0x80) {
+    bytes.append(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  bytes.append(static_cast<char>(value));
+}
+
+bool VarInt::Read(const QByteArray& bytes, int& pos, quint32& value) {
+  value = 0;
+  for (int shift = 0; pos < bytes.size() && shift < 32; shift += 7) {
+    auto byte = static_cast<quint8>(bytes[pos++]);
+    value |= static_cast<quint32>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
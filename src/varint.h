@@ -0,0 +1,17 @@
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <QByteArray>
+
+// Unsigned integers, encoded 7 bits per byte from the lowest ones, with the
+// highest bit of a byte set when more bytes follow. Small values, which
+// serialized deltas mostly are, take a byte or two.
+class VarInt {
+ public:
+  static void Write(QByteArray& bytes, quint32 value);
+  // Reads a value, starting at pos, and moves pos past it. Returns false if
+  // the bytes end before the value does.
+  static bool Read(const QByteArray& bytes, int& pos, quint32& value);
+};
+
+#endif  // VARINT_H